@@ -2,23 +2,11 @@
 #include <iostream>
 #include <iomanip>
 
-_6502_CPU::_6502_CPU() : databus(nullptr), 
-						 interruptRequested(false), 
-					 	 performInterrupt(false), 
-						 nmiRequested(false),
-						 performNMI(false),
-						 getOrPutCycle(false)  // Note: The actual starting value is random; I just set it to get (false) by default..
-{			
+_6502_CPU::_6502_CPU() : databus(nullptr) {
 	this->setupInstructionSet();
 }
 
-_6502_CPU::_6502_CPU(DataBus* databus) : databus(databus), 
-									 	 interruptRequested(false), 
-									 	 performInterrupt(false), 
-										 nmiRequested(false),
-										 performNMI(false),
-										 getOrPutCycle(false)
-{
+_6502_CPU::_6502_CPU(DataBus* databus) : databus(databus) {
 	this->setupInstructionSet();
 }
 
@@ -109,6 +97,14 @@ void _6502_CPU::alternateCycle() {
 	this->getOrPutCycle = !this->getOrPutCycle;
 }
 
+const CPUState& _6502_CPU::getState() const {
+	return *this;
+}
+
+void _6502_CPU::loadState(const CPUState& state) {
+	static_cast<CPUState&>(*this) = state;
+}
+
 void _6502_CPU::reset() {
 	// The CPU resets by decrementing the stack pointer by 3 (Going down the stack), setting the PC to the reset vector, and setting the interrupt disable to true.
 	// This process takes 7 CPU cycles.
@@ -109,7 +109,24 @@ private:
 	}
 };
 
-class _6502_CPU {
+// Every mutable value inside the CPU. This is kept trivially copyable so a snapshot of the CPU is a plain copy of this struct.
+struct CPUState {
+	Registers registers;
+
+	bool interruptRequested = false;  // Whether a REQUEST for an interrupt has been made.
+	bool performInterrupt = false;  // Whether to PERFORM an interrupt in the current cpu cycle.
+
+	bool nmiRequested = false;  // Whether a REQUEST for an NMI has been made.
+	bool lastNMISignal = false;  // The last NMI signal; so if the PPU is on Vblank, this gets set to true. This also prevents another NMI from being requested (assuming the PPU's Vblank status is still true).
+	bool performNMI = false;  // Whether to PERFORM an NMI in the current CPU cycle.
+
+	bool getOrPutCycle = false;  // Bool indicating whether the current cycle is a get (false) or a put (true) cycle. Starts as a get cycle, alternates back and forth every cycle. Note: The actual starting value is random.
+	unsigned long long totalCyclesElapsed = 0;  // Total CPU cycles elapsed since startup. 
+	unsigned int opcodeCyclesElapsed = 0;  // A cycle counter that is present since the CPU began executing a given instruction. Resets when it reaches the number of cycles for a given instruction.
+	unsigned int currentOpcodeCycleLen = 0;  // The number of cycles the current opcode uses.
+};
+
+class _6502_CPU : protected CPUState {
 public:
 	_6502_CPU();
 	_6502_CPU(DataBus* databus);
@@ -138,6 +155,10 @@ public:
 	// Turns the current cycle from get to put or from put to get.
 	void alternateCycle();
 
+	// Gets/loads every internal value of the CPU in one go.
+	const CPUState& getState() const;
+	void loadState(const CPUState& state);
+
 	/* void reset
 	Resets the CPU, which involves setting the PC to the location indicated by the reset vector and decrementing the stack pointer by 3.
 	
@@ -161,20 +182,6 @@ protected:
     // Map between bytes and their associated opcodes. NOTE: I might want to try getting this into some constant global.
 	std::map<uint8_t, Instruction> INSTRUCTION_SET;
 
-	Registers registers;
-
-	bool interruptRequested;  // Whether a REQUEST for an interrupt has been made.
-	bool performInterrupt;  // Whether to PERFORM an interrupt in the current cpu cycle.
-
-	bool nmiRequested;  // Whether a REQUEST for an NMI has been made.
-	bool lastNMISignal;  // The last NMI signal; so if the PPU is on Vblank, this gets set to true. This also prevents another NMI from being requested (assuming the PPU's Vblank status is still true).
-	bool performNMI;  // Whether to PERFORM an NMI in the current CPU cycle.  // NEW
-
-	bool getOrPutCycle;  // Bool indicating whether the current cycle is a get (false) or a put (true) cycle. Starts as a get cycle, alternates back and forth every cycle. 
-	unsigned long long totalCyclesElapsed = 0;  // Total CPU cycles elapsed since startup. 
-	unsigned int opcodeCyclesElapsed = 0;  // A cycle counter that is present since the CPU began executing a given instruction. Resets when it reaches the number of cycles for a given instruction.
-	unsigned int currentOpcodeCycleLen = 0;  // The number of cycles the current opcode uses.
-
 	void executeOpcode(uint8_t opcode);
 
 	void performInterruptActions();
@@ -1,8 +1,8 @@
 #include "directMemoryAccess.h"
 #include <sstream>
 
-OAMDMAUnit::OAMDMAUnit() : address(0), endAddress(0x100), OAMDataToTransfer(0), readOrWrite(DMACycles::CycleType::READ), databus(nullptr) {}
-OAMDMAUnit::OAMDMAUnit(NESDatabus* CPUDatabus) : address(0), endAddress(0x100), OAMDataToTransfer(0), readOrWrite(DMACycles::CycleType::READ), databus(CPUDatabus) {}
+OAMDMAUnit::OAMDMAUnit() : databus(nullptr) {}
+OAMDMAUnit::OAMDMAUnit(NESDatabus* CPUDatabus) : databus(CPUDatabus) {}
 
 OAMDMAUnit::~OAMDMAUnit() {}
 
@@ -12,6 +12,10 @@ bool OAMDMAUnit::performDMACycle(bool cpuCycleType) {
 
 	const uint16_t OAMDATA = 0x2004;  // PPU register for OAMDATA.
 
+	if (this->cyclesLeft > 0) {  // Already copied by tryBulkCopy.
+		return --this->cyclesLeft > 0;
+	}
+
 	// Write/read
 	if (this->readOrWrite == DMACycles::CycleType::WRITE && cpuCycleType) {  // Write (put, true)
 		// Write to OAM via OAMDATA. The address in the PPU for OAMDATA increments automatically when OAMDATA is written to.
@@ -45,31 +49,49 @@ void OAMDMAUnit::setPage(uint8_t page) {
 	this->endAddress = this->address + 0x100;  // We want to stop on address 0x(NN + 1)00 exclusive. 
 }
 
+bool OAMDMAUnit::tryBulkCopy(PPU& ppu, bool firstCycleIsPut) {
+	uint16_t cycles = 512 + firstCycleIsPut;
+	uint8_t page[0x100];
+	// 3 dots per cycle, plus the rest of the current CPU cycle's dots.
+	if (this->address + 0x100 != this->endAddress || !ppu.isOAMIdleFor(cycles * 3 + 3) || !this->databus->readPage(this->address >> 8, page)) {
+		return false;
+	}
+
+	ppu.writeOAMPage(page);
+
+	// Leaves the unit as the byte by byte copy does once it is done.
+	this->address = this->endAddress;
+	this->readOrWrite = DMACycles::CycleType::READ;
+	this->OAMDataToTransfer = page[0xff];
+	this->cyclesLeft = cycles;
+	return true;
+}
+
 void OAMDMAUnit::attachDatabus(NESDatabus* CPUDatabus) {
 	this->databus = CPUDatabus;
 }
 
 OAMDMAUnit& OAMDMAUnit::operator=(const OAMDMAUnit& otherDMAUnit) {
-	this->readOrWrite = otherDMAUnit.readOrWrite;
-	this->endAddress = otherDMAUnit.endAddress;
-	this->address = otherDMAUnit.address;
-	this->OAMDataToTransfer = otherDMAUnit.OAMDataToTransfer;
+	this->loadState(otherDMAUnit);
 
 	return *this;
 }
 
 OAMDMAInternals OAMDMAUnit::getInternals() const {
-	return OAMDMAInternals(this->readOrWrite, this->endAddress, this->address, this->OAMDataToTransfer);
+	return OAMDMAInternals(this->getState());
+}
+
+const OAMDMAState& OAMDMAUnit::getState() const {
+	return *this;
+}
+
+void OAMDMAUnit::loadState(const OAMDMAState& state) {
+	static_cast<OAMDMAState&>(*this) = state;
 }
 
 OAMDMAInternals::OAMDMAInternals() {}
 
-OAMDMAInternals::OAMDMAInternals(DMACycles::CycleType rOrW, uint16_t endAddr, uint16_t addr, uint8_t dataToTransfer) :
-	readOrWrite(rOrW),
-	endAddress(endAddr),
-	address(addr),
-	OAMDataToTransfer(dataToTransfer)
-{}
+OAMDMAInternals::OAMDMAInternals(const OAMDMAState& state) : OAMDMAState(state) {}
 
 OAMDMAInternals::~OAMDMAInternals()
 {
@@ -81,6 +103,7 @@ std::string OAMDMAInternals::getSerialFormat() const {
 	preSerialStr << "ENDADDR: " << (int)this->endAddress << '\n';
 	preSerialStr << "ADDR: " << (int)this->address << '\n';
 	preSerialStr << "DATATOTRANS: " << (int)this->OAMDataToTransfer << '\n';
+	preSerialStr << "CYCLESLEFT: " << (int)this->cyclesLeft << '\n';
 
 	return preSerialStr.str();
 }
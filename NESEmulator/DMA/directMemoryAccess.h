@@ -50,15 +50,19 @@ void OAMDMAUnit::attachDatabus(DataBus* CPUDatabus) {
 }
 */
 
-// Contains the internal state of a OAMDMA unit; excludes the NESDatabus pointer.
-struct OAMDMAInternals {
-	DMACycles::CycleType readOrWrite;  
-	uint16_t endAddress;
-	uint16_t address;  
-	uint8_t OAMDataToTransfer;  
+// Contains the internal state of a OAMDMA unit; excludes the NESDatabus pointer. Kept trivially copyable, like the CPU and PPU states.
+struct OAMDMAState {
+	DMACycles::CycleType readOrWrite = DMACycles::CycleType::READ;  // Whether this DMA unit needs to read (false) or write (true).
+	uint16_t endAddress = 0x100;  // The address to stop transfering data on.  
+	uint16_t address = 0;  // The address the DMA unit is currently on and planning to read.
+	uint8_t OAMDataToTransfer = 0;  // When on a cycle that stores a byte, that byte is stored in this variable. It will later be passed to a write on 0x2004 (OAMDATA).
+	uint16_t cyclesLeft = 0;  // When the page has already been copied at once (see OAMDMAUnit::tryBulkCopy), the cycles the copy still takes up.
+};
 
+// The state of a OAMDMA unit as the debugger sees it.
+struct OAMDMAInternals : public OAMDMAState {
 	OAMDMAInternals();
-	OAMDMAInternals(DMACycles::CycleType rOrW, uint16_t endAddr, uint16_t addr, uint8_t dataToTransfer);
+	OAMDMAInternals(const OAMDMAState& state);
 	~OAMDMAInternals();
 
 	// Gets the serial format of the unit (used in serializing save states).
@@ -66,7 +70,7 @@ struct OAMDMAInternals {
 };
 
 // A DMA unit for the PPU. First, it connects to the same databus the CPU uses, then, when the NES needs to use this, it calls the DMA unit to perform its action.
-class OAMDMAUnit {
+class OAMDMAUnit : protected OAMDMAState {
 public:
 	OAMDMAUnit();
 	OAMDMAUnit(NESDatabus* CPUDatabus);
@@ -78,6 +82,13 @@ public:
 
 	void setPage(uint8_t page);  // Sets the page the OAMDMA unit will copy data over from.
 
+	// Copies the whole page into OAM at once if nothing could tell it apart from copying a byte every other cycle: the page has
+	// to be plain memory (its bytes can not change while the CPU is halted, and reading them has no side effects) and OAM has to 
+	// be idle for as long as the DMA takes (see PPU::isOAMIdleFor). performDMACycle then just counts down the cycles the copy 
+	// would have taken, 512 plus 1 to line up w/ a get cycle if the first is a put. Returns whether the page was copied. 
+	// Should be called right before the first cycle of the DMA.
+	bool tryBulkCopy(PPU& ppu, bool firstCycleIsPut);
+
 	// Things needed to attach
 	void attachDatabus(NESDatabus* CPUDatabus);  // Attached a databus to this unit; the databus you attach should be the same one used by the CPU.
 
@@ -87,11 +98,10 @@ public:
 	// Returns a copy of the internal state of this unit.
 	OAMDMAInternals getInternals() const;
 
+	const OAMDMAState& getState() const;
+	void loadState(const OAMDMAState& state);
+
 private:
-	DMACycles::CycleType readOrWrite;  // Whether this DMA unit needs to read (false) or write (true).
-	uint16_t endAddress;  // The address to stop transfering data on.  
-	uint16_t address;  // The address the DMA unit is currently on and planning to read.
-	uint8_t OAMDataToTransfer;  // When on a cycle that stores a byte, that byte is stored in this variable. It will later be passed to a write on 0x2004 (OAMDATA).
 	NESDatabus* databus;  // This should be the same databus the CPU uses.
 
 };
\ No newline at end of file
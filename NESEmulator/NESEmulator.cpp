@@ -10,6 +10,8 @@ NES::NES() :
 	DMAUnit(nullptr), 
 	haltCPUOAM(false), 
 	scheduleHalt(false), 
+	fastOAMDMA(true),
+	nextButtonChange(std::numeric_limits<unsigned long long>::max()),
 	totalMachineCycles(0) {
 
 	/*
@@ -18,14 +20,15 @@ NES::NES() :
 	this->databus = new NESDatabus(this->memory);
 	this->CPU = new _6502_CPU(this->databus);
 
-	this->VRAM = new Memory(0x800);
+	this->VRAM = new VideoRAM();
 	this->ppu = new PPU(this->VRAM, nullptr);
 	
 	this->DMAUnit.attachDatabus(this->databus);
 	*/
 }
 
-NES::NES(NESDatabus* databus, _6502_CPU* CPU, RAM* ram, Memory* vram, PPU* ppu) : DMAUnit(databus), haltCPUOAM(false), scheduleHalt(false), totalMachineCycles(0) {
+NES::NES(NESDatabus* databus, _6502_CPU* CPU, RAM* ram, VideoRAM* vram, PPU* ppu) : DMAUnit(databus), haltCPUOAM(false), scheduleHalt(false), fastOAMDMA(true), nextButtonChange(std::numeric_limits<unsigned long long>::max()), totalMachineCycles(0) {
+	this->apu.attachDatabus(databus);
 	this->ram = ram;
 	this->ppu = ppu;
 	this->VRAM = vram;
@@ -38,6 +41,7 @@ NES::NES(NESDatabus* databus, _6502_CPU* CPU, RAM* ram, Memory* vram, PPU* ppu)
 	this->CPU->attach(this->databus);
 
 	this->databus->attach(&this->input_port);
+	this->databus->attach(&this->apu);
 }
 
 NES::~NES() {}
@@ -71,6 +75,8 @@ void NES::attachDataBus(NESDatabus* databus) {
 	this->databus->attach(this->ram);
 	this->DMAUnit.attachDatabus(this->databus);
 	this->databus->attach(&this->input_port);
+	this->databus->attach(&this->apu);
+	this->apu.attachDatabus(this->databus);
 }
 
 void NES::attachPPU(PPU* ppu) {
@@ -81,7 +87,7 @@ void NES::attachPPU(PPU* ppu) {
 	}
 }
 
-void NES::attachVRAM(Memory* vram) {
+void NES::attachVRAM(VideoRAM* vram) {
 	this->VRAM = vram;
 	if (this->ppu != nullptr) {
 		this->ppu->attachVRAM(vram);
@@ -99,10 +105,12 @@ void NES::powerOn() {
 		this->ppu->executePPUCycle();
 	}
 	this->CPU->powerOn();
+	this->apu.powerOn();
 }
 
 void NES::reset() {
 	this->CPU->reset();
+	this->apu.reset();
 }
 
 void NES::loadROM(const char* fileName) {  // Remember to reset the NES after loading a ROM.
@@ -116,12 +124,119 @@ void NES::loadROM(const char* fileName) {  // Remember to reset the NES after lo
 	}
 }
 
+void NES::getState(NESState& state) const {
+	state.cpu = this->CPU->getState();
+	state.ppu = this->ppu->getState();
+	state.dma = this->DMAUnit.getState();
+	state.apu = this->apu.getState();
+	state.ram = *this->ram;
+	state.vram = *this->VRAM;
+	this->memory->getBytes(PRG_RAM_START, state.PRGRAM.getData(), PRG_RAM_SIZE);
+	if (this->CHRDATA) {
+		this->CHRDATA->getBytes(0, state.CHRDATA.getData(), CHRDATA_SIZE);
+	} else {
+		state.CHRDATA = FixedMemory<CHRDATA_SIZE>();
+	}
+	state.controllerShiftRegister = this->input_port.getShiftRegister();
+
+	state.scheduleHalt = this->scheduleHalt;
+	state.haltCPUOAM = this->haltCPUOAM;
+	state.totalMachineCycles = this->totalMachineCycles;
+}
+
+void NES::loadState(const NESState& state) {
+	this->CPU->loadState(state.cpu);
+	this->ppu->loadState(state.ppu);
+	this->DMAUnit.loadState(state.dma);
+	this->apu.loadState(state.apu);
+	*this->ram = state.ram;
+	*this->VRAM = state.vram;
+	this->memory->setBytes(PRG_RAM_START, state.PRGRAM.getData(), PRG_RAM_SIZE);
+	if (this->CHRDATA) {
+		this->CHRDATA->setBytes(0, state.CHRDATA.getData(), CHRDATA_SIZE);
+	}
+	this->input_port.loadShiftRegister(state.controllerShiftRegister);
+
+	this->scheduleHalt = state.scheduleHalt;
+	this->haltCPUOAM = state.haltCPUOAM;
+	this->totalMachineCycles = state.totalMachineCycles;
+}
+
+void NES::takeSnapshot(NESSnapshot& snapshot) const {
+	this->getState(snapshot.state);
+	snapshot.buttons = this->input_port.getButtons();
+	snapshot.cartridgeMemory = this->memory->share();
+	snapshot.CHRDATA = this->CHRDATA ? this->CHRDATA->share() : nullptr;
+}
+
+void NES::restore(const NESSnapshot& snapshot) {
+	// The cartridge first, so loadState finds its RAM already matching and leaves the shared data alone.
+	this->memory->restore(snapshot.cartridgeMemory);
+	if (this->CHRDATA && snapshot.CHRDATA) {
+		this->CHRDATA->restore(snapshot.CHRDATA);
+	}
+	this->loadState(snapshot.state);
+	this->queuedButtons.clear();
+	this->nextButtonChange = std::numeric_limits<unsigned long long>::max();
+	this->input_port.setButtons(snapshot.buttons);
+}
+
+void NES::serializeState(std::vector<uint8_t>& buffer) const {
+	NESState state;
+	this->getState(state);
+	encodeState(state, buffer);
+}
+
+SaveStateResult::SaveStateResult NES::deserializeState(const uint8_t* data, size_t size) {
+	// Decode into a temporary so a bad savestate leaves the NES untouched. It starts as the NES is now, so what an older savestate 
+	// lacks (e.g. the cartridge's RAM) is kept rather than cleared.
+	NESState state;
+	this->getState(state);
+	SaveStateResult::SaveStateResult result = decodeState(data, size, state);
+	if (result == SaveStateResult::SUCCESS) {
+		this->loadState(state);
+	}
+
+	return result;
+}
+
+SaveStateResult::SaveStateResult NES::saveStateToFile(const char* fileName) const {
+	std::vector<uint8_t> buffer;
+	this->serializeState(buffer);
+
+	std::ofstream file{ fileName, std::ios::binary };
+	if (!file.is_open()) {
+		return SaveStateResult::CANT_OPEN_FILE;
+	}
+	file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+	return file.good() ? SaveStateResult::SUCCESS : SaveStateResult::CANT_OPEN_FILE;
+}
+
+SaveStateResult::SaveStateResult NES::loadStateFromFile(const char* fileName) {
+	std::ifstream file{ fileName, std::ios::binary };
+	if (!file.is_open()) {
+		return SaveStateResult::CANT_OPEN_FILE;
+	}
+	std::vector<uint8_t> buffer{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	return this->deserializeState(buffer.data(), buffer.size());
+}
+
 NESCycleOutcomes NES::performCPUCycle() {
 	NESCycleOutcomes nesResult = PPU_CYCLE;
 	CPUCycleOutcomes cpuResult = PASS;
 
+	// The APU goes first so a DMC sample fetch due this cycle stalls the CPU from this cycle on. The DMC's stall is taken after 
+	// any OAM DMA rather than overlapping it.
+	this->apu.clock();
+	bool dmcStall = !this->haltCPUOAM && this->apu.takeStallCycle();
+	if (this->apu.requestingIRQ()) {
+		this->CPU->requestInterrupt();  // The IRQ line is level triggered, so it is requested for as long as it is held.
+	}
+
 	// Execute a CPU cycle.
-	cpuResult = this->CPU->executeCycle(this->haltCPUOAM);
+	cpuResult = this->CPU->executeCycle(this->haltCPUOAM || dmcStall);
 
 	switch (cpuResult) {
 	case(INSTRUCTION_EXECUTED): 
@@ -135,7 +250,7 @@ NESCycleOutcomes NES::performCPUCycle() {
 		break;
 	}
 	
-	if (this->haltCPUOAM) {  // If it is halted, then perform the appropriate DMA action. NOTE: I will need to later expand this to work with the APU's DMA.
+	if (this->haltCPUOAM) {  // If it is halted, then perform the appropriate DMA action.
 		this->haltCPUOAM = this->DMAUnit.performDMACycle(this->CPU->getCycleType());
 	}
 
@@ -143,6 +258,9 @@ NESCycleOutcomes NES::performCPUCycle() {
 	if (this->scheduleHalt) {
 		this->haltCPUOAM = true;
 		this->scheduleHalt = false;
+		if (this->fastOAMDMA) {
+			this->DMAUnit.tryBulkCopy(*this->ppu, !this->CPU->getCycleType());  // The cycle type has not alternated yet.
+		}
 	}
 
 	// Lastly, alternate the CPU cycle type.
@@ -169,6 +287,10 @@ NESCycleOutcomes NES::executeMachineCycle() {
 	// NOTE: The master clock on the real NES runs 3x faster, so 1 PPU cycle every 3 master clock cycles. 
 	// This detail won't affect the behavior of this emulator, so we just make 1 machine cycle equal to 1 ppu cycle.
 	NESCycleOutcomes nesResult = PPU_CYCLE;
+
+	if (this->totalMachineCycles >= this->nextButtonChange) {
+		this->applyQueuedButtons();
+	}
 	
 	// Performing the CPU cycle;
 	if (this->totalMachineCycles % 3 == 0) {
@@ -182,6 +304,81 @@ NESCycleOutcomes NES::executeMachineCycle() {
 	return nesResult;
 }
 
+NESCycleOutcomes NES::executeFrame() {
+	NESCycleOutcomes nesResult = PPU_CYCLE;
+	bool failed = false;
+
+	int startFrame = this->ppu->getFrameCount();
+	while (this->ppu->getFrameCount() == startFrame) {
+		nesResult = this->executeMachineCycle();
+		failed |= nesResult == FAIL_CYCLE;
+	}
+	this->apu.endAudioFrame();
+
+	return failed ? FAIL_CYCLE : nesResult;
+}
+
+unsigned long long NES::getTotalMachineCycles() const {
+	return this->totalMachineCycles;
+}
+
+void NES::queueButtons(unsigned long long machineCycle, uint8_t buttons) {
+	this->queuedButtons.push_back({ machineCycle, buttons });
+	this->nextButtonChange = this->queuedButtons.front().machineCycle;
+}
+
+void NES::flushQueuedButtons() {
+	if (!this->queuedButtons.empty()) {
+		this->input_port.setButtons(this->queuedButtons.back().buttons);
+		this->queuedButtons.clear();
+	}
+	this->nextButtonChange = std::numeric_limits<unsigned long long>::max();
+}
+
+void NES::applyQueuedButtons() {
+	while (!this->queuedButtons.empty() && this->queuedButtons.front().machineCycle <= this->totalMachineCycles) {
+		this->input_port.setButtons(this->queuedButtons.front().buttons);
+		this->queuedButtons.pop_front();
+	}
+	this->nextButtonChange = this->queuedButtons.empty() ? std::numeric_limits<unsigned long long>::max() : this->queuedButtons.front().machineCycle;
+}
+
+void NES::setVideoOutput(bool enabled) {
+	this->ppu->setOutputEnabled(enabled);
+}
+
+void NES::setRenderInterval(unsigned int interval) {
+	this->ppu->setRenderInterval(interval);
+}
+
+void NES::requestFrame() {
+	this->ppu->requestFrame();
+}
+
+void NES::setFastOAMDMA(bool enabled) {
+	this->fastOAMDMA = enabled;
+}
+
+void NES::setAudioOutput(bool enabled) {
+	this->apu.setOutputEnabled(enabled);
+}
+
+void NES::setAudioSampleRate(double sampleRate) {
+	this->apu.setSampleRate(sampleRate);
+}
+
+void NES::setAudioRateAdjustment(double adjustment) {
+	this->apu.setRateAdjustment(adjustment);
+}
+
+size_t NES::getAudioSamplesAvailable() const {
+	return this->apu.getSamplesAvailable();
+}
+
+size_t NES::readAudioSamples(int16_t* out, size_t count) {
+	return this->apu.readSamples(out, count);
+}
+
 void NES::loadData(NESFileData file) {
 	// Then we load in ROM data.
 
@@ -212,5 +409,6 @@ void NES::loadData(NESFileData file) {
 	}
 
 	// Attaching CHRDATA to the PPU.
-	ppu->attachCHRDATA(file.CHRDATA);
+	this->CHRDATA = file.CHRDATA;
+	ppu->attachCHRDATA(this->CHRDATA.get());
 }
@@ -4,16 +4,23 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <type_traits>
 
 #include "6502Chip/CPU.h"
 #include "memory/memory.h"
+#include "memory/cartridgeData.h"
 #include "databus/databus.h"
 #include "loadingData/parseNESFiles.h"
 #include "memory/ram.h"
 #include "databus/nesDatabus.h"
 #include "DMA/directMemoryAccess.h"
+#include "apu/apu.h"
 #include "input/inputPort.h"
 #include "input/controller.h"
+#include "savestates/saveState.h"
 
 enum NESCycleOutcomes {
 	FAIL_CYCLE,  // Usually caused by an illegal instruction.
@@ -23,14 +30,75 @@ enum NESCycleOutcomes {
 	OAMDMA_CYCLE  // The NES is currently doing OAM DMA and has suspended the CPU.
 };
 
+// All of the mutable state of the NES (i.e. everything except ROM) in one trivially copyable block,
+// so taking or restoring a snapshot of the machine is a handful of plain struct copies and copying a snapshot is a single memcpy.
+struct alignas(64) NESState {
+	CPUState cpu;
+	PPUState ppu;
+	OAMDMAState dma;
+	APUState apu;
+	RAM ram;
+	VideoRAM vram;
+	FixedMemory<PRG_RAM_SIZE> PRGRAM;
+	FixedMemory<CHRDATA_SIZE> CHRDATA;  // Kept whether it is RAM or ROM; for CHR ROM, loading it back never changes anything.
+	_4021 controllerShiftRegister;
+
+	bool scheduleHalt = false;
+	bool haltCPUOAM = false;
+	unsigned long long totalMachineCycles = 0;
+};
+static_assert(std::is_trivially_copyable_v<NESState>, "NESState must stay trivially copyable so it can be memcpy'd.");
+
+// Everything about a NES which changes as it runs: its NESState, plus the buttons held and the whole of the cartridge's memory 
+// and CHRDATA (NESState only has the parts meant to be written to). Those are shared copy-on-write (see Memory::share), so taking 
+// or restoring a snapshot costs about as much as copying an NESState, and the snapshots of a game (and the NESs they are restored 
+// into) all share one copy of its ROM. Like NESState, it is only valid for the build and game which made it.
+struct NESSnapshot {
+	NESState state;
+	uint8_t buttons = 0;
+	std::shared_ptr<const std::vector<uint8_t>> cartridgeMemory, CHRDATA;
+};
+
 class NES {
 public:
 	NES();
-	NES(NESDatabus* databus, _6502_CPU* CPU, RAM* ram, Memory* vram, PPU* ppu);
+	NES(NESDatabus* databus, _6502_CPU* CPU, RAM* ram, VideoRAM* vram, PPU* ppu);
 	~NES();
 
 	virtual NESCycleOutcomes executeMachineCycle();
 
+	// Executes machine cycles until the PPU starts a new frame. Returns FAIL_CYCLE if any cycle failed, otherwise the outcome of 
+	// the last cycle. The frame's audio is readable afterwards.
+	NESCycleOutcomes executeFrame();
+
+	unsigned long long getTotalMachineCycles() const;
+
+	// Sets the buttons held on the attached controller (see StandardController::setButtons) once machineCycle is reached, so a 
+	// change can land in the middle of a frame (see InputTimeline). Changes must be queued in order of their cycles; one queued for 
+	// a cycle which has already passed happens before the next cycle. The queue is not part of the NES's state, so it should be 
+	// flushed before loading a state from another point in time.
+	void queueButtons(unsigned long long machineCycle, uint8_t buttons);
+	void flushQueuedButtons();  // Makes every queued change happen now.
+
+	// Enables or disables drawing to the PPU's graphics object; see PPU::setOutputEnabled.
+	void setVideoOutput(bool enabled);
+	// Composes only every interval-th frame, and the next one after requestFrame; see PPU::setRenderInterval.
+	void setRenderInterval(unsigned int interval);
+	void requestFrame();
+
+	// Whether OAM DMA copies its page at once when it can (see OAMDMAUnit::tryBulkCopy) or always a byte every other cycle. 
+	// On by default; the result is the same, but the debugger turns it off so it can step through the copy.
+	void setFastOAMDMA(bool enabled);
+
+	// The APU's output: mono 16 bit samples at the sample rate (48 kHz unless set). Disabling the output makes the time which 
+	// passes silent and produce no samples (e.g. for frames which are run ahead and thrown away); see APU.
+	void setAudioOutput(bool enabled);
+	void setAudioSampleRate(double sampleRate);
+	// Produces (1 + adjustment) times as many samples per frame; see AudioStream for keeping an audio device fed w/ it.
+	void setAudioRateAdjustment(double adjustment);
+	size_t getAudioSamplesAvailable() const;
+	size_t readAudioSamples(int16_t* out, size_t count);
+
 	void powerOn();  // Performs all the actions the NES should perform upon a power on.
 	void reset();  // Performs the actions the NES should perform when reset.
 
@@ -40,11 +108,27 @@ public:
 	virtual void attachCartridgeMemory(Memory* memory);
 	virtual void attachDataBus(NESDatabus* databus);
 	virtual void attachPPU(PPU* ppu);
-	virtual void attachVRAM(Memory* vram);
+	virtual void attachVRAM(VideoRAM* vram);
 	virtual void attachController(StandardController* controller);
 	
 	void loadROM(const char* fileName);
 
+	// Copies the state of every attached component into the given state, or loads it back in. All components must be attached.
+	void getState(NESState& state) const;
+	void loadState(const NESState& state);
+
+	// Takes or restores a snapshot of the NES (see NESSnapshot), e.g. to branch a game thousands of times in a search. Restoring 
+	// drops any queued button changes (see queueButtons) since they belong to where the NES was before.
+	void takeSnapshot(NESSnapshot& snapshot) const;
+	void restore(const NESSnapshot& snapshot);
+
+	// Binary savestates (see savestates/saveState.h for the format). Serializing appends to the given buffer. Nothing is changed if 
+	// deserializing or loading fails.
+	void serializeState(std::vector<uint8_t>& buffer) const;
+	SaveStateResult::SaveStateResult deserializeState(const uint8_t* data, size_t size);
+	SaveStateResult::SaveStateResult saveStateToFile(const char* fileName) const;
+	SaveStateResult::SaveStateResult loadStateFromFile(const char* fileName);
+
 protected:
 
 	NESCycleOutcomes performCPUCycle();
@@ -63,20 +147,31 @@ protected:
 
 	// Initialized by NES; 
 	Memory* memory;  // Contains cartridge data, etc.
+	std::shared_ptr<Memory> CHRDATA;  // The CHRDATA of the loaded ROM; shared w/ the NESFileData it was loaded from.
 	
 	_6502_CPU* CPU;
 	RAM* ram;  // Initialized by NES; can not be remapped.
 	NESDatabus* databus;
 
-	Memory* VRAM;  // Initialized to size 0x800 by NES; TODO: make it attach/deattachable (to support mappers).
+	VideoRAM* VRAM;  // TODO: make it attach/deattachable (to support mappers).
 	PPU* ppu;
 
 	OAMDMAUnit DMAUnit;  // NOTE: Might replace w/ a pointer. 
+	APU apu;
 	bool scheduleHalt;  // Whether to halt the CPU next cycle.  
 	bool haltCPUOAM;  // Whether the CPU is halted for OAMDMA.
+	bool fastOAMDMA;
 
 	InputPort input_port;  // The port which controllers attach to.
 
+	struct ButtonChange {
+		unsigned long long machineCycle;
+		uint8_t buttons;
+	};
+	std::deque<ButtonChange> queuedButtons;
+	unsigned long long nextButtonChange;  // The cycle of the first queued change; the maximum value if there are none.
+	void applyQueuedButtons();  // Makes every queued change due by now happen.
+
 	unsigned long long totalMachineCycles;
 	//uint64_t totalCPUCycles;  // [DEPRECATED] NOTE: Might remove as it redundant.
 };
\ No newline at end of file
@@ -0,0 +1,565 @@
+#include "apu.h"
+
+#include "../databus/databus.h"
+
+#include <algorithm>
+
+namespace {
+	const uint8_t LENGTH_TABLE[32] = {
+		10, 254, 20, 2, 40, 4, 80, 6, 160, 8, 60, 10, 14, 12, 26, 14,
+		12, 16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30
+	};
+	const uint8_t DUTY_SEQUENCES[4][8] = {
+		{ 0, 1, 0, 0, 0, 0, 0, 0 },
+		{ 0, 1, 1, 0, 0, 0, 0, 0 },
+		{ 0, 1, 1, 1, 1, 0, 0, 0 },
+		{ 1, 0, 0, 1, 1, 1, 1, 1 }
+	};
+	const uint8_t TRIANGLE_SEQUENCE[32] = {
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+	};
+	// Periods in CPU cycles (NTSC).
+	const uint16_t NOISE_PERIODS[16] = { 4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068 };
+	const uint16_t DMC_PERIODS[16] = { 428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54 };
+
+	// When each step of the frame counter's sequences happens, in CPU cycles after the sequence starts, and how long they are.
+	const uint32_t FOUR_STEP_CYCLES[4] = { 7457, 14913, 22371, 29829 };
+	const uint32_t FOUR_STEP_PERIOD = 29830;
+	const uint32_t FIVE_STEP_CYCLES[5] = { 7457, 14913, 22371, 29829, 37281 };
+	const uint32_t FIVE_STEP_PERIOD = 37282;
+
+	const unsigned int DMC_STALL_CYCLES = 4;
+
+	// The linear approximation of the mixer: how much a level of 1 on each channel adds to the output (1.0 = full scale).
+	const float CHANNEL_WEIGHTS[5] = { 0.00752f, 0.00752f, 0.00851f, 0.00494f, 0.00335f };
+
+	// Advances a timer w/ the given period by the given number of cycles; returns how many times it was clocked.
+	uint64_t advanceTimer(uint32_t& counter, uint32_t period, uint64_t cycles) {
+		if (cycles < counter) {
+			counter -= static_cast<uint32_t>(cycles);
+			return 0;
+		}
+		cycles -= counter;
+		counter = period - static_cast<uint32_t>(cycles % period);
+		return 1 + cycles / period;
+	}
+
+	uint8_t getEnvelopeVolume(const EnvelopeState& envelope) {
+		return envelope.constantVolume ? envelope.volume : envelope.decay;
+	}
+
+	void clockEnvelope(EnvelopeState& envelope) {
+		if (envelope.start) {
+			envelope.start = false;
+			envelope.decay = 15;
+			envelope.divider = envelope.volume;
+		} else if (envelope.divider == 0) {
+			envelope.divider = envelope.volume;
+			if (envelope.decay > 0) {
+				--envelope.decay;
+			} else if (envelope.loop) {
+				envelope.decay = 15;
+			}
+		} else {
+			--envelope.divider;
+		}
+	}
+
+	void clockLengthCounter(uint8_t& lengthCounter, bool halt) {
+		if (!halt && lengthCounter > 0) {
+			--lengthCounter;
+		}
+	}
+
+	// Where the sweep unit would move the pulse's period to. Pulse 1 negates w/ one's complement, pulse 2 w/ two's complement.
+	int getSweepTarget(const PulseState& pulse, unsigned int index) {
+		int change = pulse.timerPeriod >> pulse.sweepShift;
+		if (pulse.sweepNegate) {
+			return std::max(0, pulse.timerPeriod - change - (index == 0 ? 1 : 0));
+		}
+		return pulse.timerPeriod + change;
+	}
+}
+
+APU::APU() : databus(nullptr), blip(NTSC_CPU_CLOCK_RATE, 48000), outputLevels{}, audioFrameStart(0), outputEnabled(true) {}
+APU::~APU() {}
+
+void APU::attachDatabus(DataBus* databus) {
+	this->databus = databus;
+}
+
+void APU::powerOn() {
+	this->loadState(APUState());
+}
+
+void APU::reset() {
+	// Silences every channel; the frame counter keeps its mode but starts its sequence over.
+	this->writeRegister(0x4015, 0);
+	this->frameIRQ = false;
+	this->restartFrameSequence(this->cycle);
+	this->updateNextEvent();
+}
+
+uint8_t APU::readRegister(uint16_t address) {
+	if (address != 0x4015) {
+		return static_cast<uint8_t>(address >> 8);  // Open bus; usually the high byte of the address, the last thing on the bus.
+	}
+
+	this->runUntil(this->cycle);
+	uint8_t status = 0;
+	status |= (this->pulse[0].lengthCounter > 0) << 0;
+	status |= (this->pulse[1].lengthCounter > 0) << 1;
+	status |= (this->triangle.lengthCounter > 0) << 2;
+	status |= (this->noise.lengthCounter > 0) << 3;
+	status |= (this->dmc.bytesRemaining > 0) << 4;
+	status |= this->frameIRQ << 6;
+	status |= this->dmcIRQ << 7;
+
+	this->frameIRQ = false;  // Reading acknowledges the frame IRQ (but not the DMC's).
+	return status;
+}
+
+void APU::writeRegister(uint16_t address, uint8_t value) {
+	this->runUntil(this->cycle);
+
+	switch (address) {
+	case(0x4000):  // Pulse duty, envelope
+	case(0x4004): {
+		PulseState& pulse = this->pulse[(address >> 2) & 1];
+		pulse.duty = value >> 6;
+		pulse.envelope.loop = value & 0x20;
+		pulse.envelope.constantVolume = value & 0x10;
+		pulse.envelope.volume = value & 0x0f;
+		break;
+	}
+	case(0x4001):  // Pulse sweep
+	case(0x4005): {
+		PulseState& pulse = this->pulse[(address >> 2) & 1];
+		pulse.sweepEnabled = value & 0x80;
+		pulse.sweepPeriod = (value >> 4) & 0x07;
+		pulse.sweepNegate = value & 0x08;
+		pulse.sweepShift = value & 0x07;
+		pulse.sweepReload = true;
+		break;
+	}
+	case(0x4002):  // Pulse timer low
+	case(0x4006): {
+		PulseState& pulse = this->pulse[(address >> 2) & 1];
+		pulse.timerPeriod = (pulse.timerPeriod & 0x700) | value;
+		break;
+	}
+	case(0x4003):  // Pulse length, timer high
+	case(0x4007): {
+		unsigned int index = (address >> 2) & 1;
+		PulseState& pulse = this->pulse[index];
+		pulse.timerPeriod = (pulse.timerPeriod & 0xff) | ((value & 0x07) << 8);
+		if (this->channelsEnabled & (1 << index)) {
+			pulse.lengthCounter = LENGTH_TABLE[value >> 3];
+		}
+		pulse.sequenceStep = 0;
+		pulse.envelope.start = true;
+		break;
+	}
+	case(0x4008):  // Triangle linear counter
+		this->triangle.control = value & 0x80;
+		this->triangle.linearReloadValue = value & 0x7f;
+		break;
+	case(0x400a):  // Triangle timer low
+		this->triangle.timerPeriod = (this->triangle.timerPeriod & 0x700) | value;
+		break;
+	case(0x400b):  // Triangle length, timer high
+		this->triangle.timerPeriod = (this->triangle.timerPeriod & 0xff) | ((value & 0x07) << 8);
+		if (this->channelsEnabled & (1 << TRIANGLE)) {
+			this->triangle.lengthCounter = LENGTH_TABLE[value >> 3];
+		}
+		this->triangle.linearReload = true;
+		break;
+	case(0x400c):  // Noise envelope
+		this->noise.envelope.loop = value & 0x20;
+		this->noise.envelope.constantVolume = value & 0x10;
+		this->noise.envelope.volume = value & 0x0f;
+		break;
+	case(0x400e):  // Noise mode, period
+		this->noise.mode = value & 0x80;
+		this->noise.periodIndex = value & 0x0f;
+		break;
+	case(0x400f):  // Noise length
+		if (this->channelsEnabled & (1 << NOISE)) {
+			this->noise.lengthCounter = LENGTH_TABLE[value >> 3];
+		}
+		this->noise.envelope.start = true;
+		break;
+	case(0x4010):  // DMC IRQ, loop, rate
+		this->dmc.irqEnabled = value & 0x80;
+		this->dmc.loop = value & 0x40;
+		this->dmc.rateIndex = value & 0x0f;
+		if (!this->dmc.irqEnabled) {
+			this->dmcIRQ = false;
+		}
+		break;
+	case(0x4011):  // DMC direct load
+		this->dmc.outputLevel = value & 0x7f;
+		break;
+	case(0x4012):  // DMC sample address
+		this->dmc.sampleAddress = 0xc000 + value * 64;
+		break;
+	case(0x4013):  // DMC sample length
+		this->dmc.sampleLength = value * 16 + 1;
+		break;
+	case(0x4015):  // Channel enables
+		this->channelsEnabled = value & 0x1f;
+		for (unsigned int i = 0; i < 2; ++i) {
+			if (!(value & (1 << i))) {
+				this->pulse[i].lengthCounter = 0;
+			}
+		}
+		if (!(value & (1 << TRIANGLE))) {
+			this->triangle.lengthCounter = 0;
+		}
+		if (!(value & (1 << NOISE))) {
+			this->noise.lengthCounter = 0;
+		}
+		if (!(value & (1 << DMC))) {
+			this->dmc.bytesRemaining = 0;
+		} else if (this->dmc.bytesRemaining == 0) {
+			this->dmc.currentAddress = this->dmc.sampleAddress;
+			this->dmc.bytesRemaining = this->dmc.sampleLength;
+			this->fetchDMCSample();
+		}
+		this->dmcIRQ = false;
+		break;
+	case(0x4017):  // Frame counter
+		this->fiveStepMode = value & 0x80;
+		this->irqInhibit = value & 0x40;
+		if (this->irqInhibit) {
+			this->frameIRQ = false;
+		}
+		this->restartFrameSequence(this->cycle + 3);  // The new sequence starts 3 or 4 cycles after the write.
+		if (this->fiveStepMode) {
+			this->clockQuarterFrame();
+			this->clockHalfFrame();
+		}
+		break;
+	default:
+		break;
+	}
+
+	this->updateAllOutputs(this->cycle);
+	this->updateNextEvent();
+}
+
+void APU::endAudioFrame() {
+	this->runUntil(this->cycle);
+	if (this->outputEnabled) {
+		this->blip.endFrame(static_cast<uint32_t>(this->cycle - this->audioFrameStart));
+	}
+	this->audioFrameStart = this->cycle;
+}
+
+void APU::setOutputEnabled(bool enabled) {
+	if (enabled == this->outputEnabled) {
+		return;
+	}
+
+	this->endAudioFrame();  // Keeps the audio up to now if it was enabled; otherwise skips the time which passed w/o output.
+	this->outputEnabled = enabled;
+	if (enabled) {
+		this->updateAllOutputs(this->cycle);
+	}
+}
+
+void APU::setSampleRate(double sampleRate) {
+	this->blip.setRates(NTSC_CPU_CLOCK_RATE, sampleRate);
+	std::fill(std::begin(this->outputLevels), std::end(this->outputLevels), 0);  // The new buffer starts from silence.
+	this->audioFrameStart = this->lastRunCycle;
+	this->updateAllOutputs(this->lastRunCycle);
+}
+
+void APU::setRateAdjustment(double adjustment) {
+	this->blip.setRateAdjustment(adjustment);
+}
+
+size_t APU::getSamplesAvailable() const {
+	return this->blip.getSamplesAvailable();
+}
+
+size_t APU::readSamples(int16_t* out, size_t count) {
+	return this->blip.readSamples(out, count);
+}
+
+const APUState& APU::getState() const {
+	return *this;
+}
+
+void APU::loadState(const APUState& state) {
+	// The audio up to now is kept, then the restored state's audio continues from where it left off.
+	this->endAudioFrame();
+	static_cast<APUState&>(*this) = state;
+	this->audioFrameStart = this->lastRunCycle;
+	this->updateAllOutputs(this->lastRunCycle);
+}
+
+void APU::runUntil(uint64_t target) {
+	while (this->nextFrameStepCycle <= target) {
+		uint64_t stepCycle = this->nextFrameStepCycle;
+		this->runPulse(0, this->lastRunCycle, stepCycle);
+		this->runPulse(1, this->lastRunCycle, stepCycle);
+		this->runTriangle(this->lastRunCycle, stepCycle);
+		this->runNoise(this->lastRunCycle, stepCycle);
+		this->runDMC(this->lastRunCycle, stepCycle);
+		this->lastRunCycle = stepCycle;
+
+		this->clockFrameStep();
+		this->updateAllOutputs(stepCycle);
+	}
+
+	if (target > this->lastRunCycle) {
+		this->runPulse(0, this->lastRunCycle, target);
+		this->runPulse(1, this->lastRunCycle, target);
+		this->runTriangle(this->lastRunCycle, target);
+		this->runNoise(this->lastRunCycle, target);
+		this->runDMC(this->lastRunCycle, target);
+		this->lastRunCycle = target;
+	}
+
+	this->updateNextEvent();
+}
+
+void APU::runPulse(unsigned int index, uint64_t from, uint64_t to) {
+	PulseState& pulse = this->pulse[index];
+	uint32_t period = (pulse.timerPeriod + 1) * 2;  // The timer is clocked every other CPU cycle.
+
+	// A silent channel can not change its level until the next frame step or register write, so it just skips ahead.
+	if (pulse.lengthCounter == 0 || this->isPulseMuted(index) || getEnvelopeVolume(pulse.envelope) == 0) {
+		uint64_t clocks = advanceTimer(pulse.timerCounter, period, to - from);
+		pulse.sequenceStep = (pulse.sequenceStep + clocks) & 7;
+		return;
+	}
+
+	Channel channel = index == 0 ? PULSE_1 : PULSE_2;
+	uint64_t time = from;
+	while (to - time >= pulse.timerCounter) {
+		time += pulse.timerCounter;
+		pulse.timerCounter = period;
+		pulse.sequenceStep = (pulse.sequenceStep + 1) & 7;
+		this->updateOutput(channel, this->getPulseLevel(index), time);
+	}
+	pulse.timerCounter -= static_cast<uint32_t>(to - time);
+}
+
+void APU::runTriangle(uint64_t from, uint64_t to) {
+	uint32_t period = this->triangle.timerPeriod + 1;
+
+	// The sequencer only moves while both counters are nonzero. Periods under 2 would be ultrasonic; like most emulators, the
+	// triangle is held instead, which avoids the pops the real thing makes.
+	if (this->triangle.lengthCounter == 0 || this->triangle.linearCounter == 0 || this->triangle.timerPeriod < 2) {
+		advanceTimer(this->triangle.timerCounter, period, to - from);
+		return;
+	}
+
+	uint64_t time = from;
+	while (to - time >= this->triangle.timerCounter) {
+		time += this->triangle.timerCounter;
+		this->triangle.timerCounter = period;
+		this->triangle.sequenceStep = (this->triangle.sequenceStep + 1) & 31;
+		this->updateOutput(TRIANGLE, this->getTriangleLevel(), time);
+	}
+	this->triangle.timerCounter -= static_cast<uint32_t>(to - time);
+}
+
+void APU::runNoise(uint64_t from, uint64_t to) {
+	uint32_t period = NOISE_PERIODS[this->noise.periodIndex];
+	unsigned int feedbackBit = this->noise.mode ? 6 : 1;
+	bool audible = this->noise.lengthCounter > 0 && getEnvelopeVolume(this->noise.envelope) > 0;
+
+	// The shift register is always stepped (even when silent) so the sequence is the same however the batches fall.
+	uint64_t time = from;
+	while (to - time >= this->noise.timerCounter) {
+		time += this->noise.timerCounter;
+		this->noise.timerCounter = period;
+
+		uint16_t feedback = (this->noise.shiftRegister ^ (this->noise.shiftRegister >> feedbackBit)) & 1;
+		this->noise.shiftRegister = (this->noise.shiftRegister >> 1) | (feedback << 14);
+		if (audible) {
+			this->updateOutput(NOISE, this->getNoiseLevel(), time);
+		}
+	}
+	this->noise.timerCounter -= static_cast<uint32_t>(to - time);
+}
+
+void APU::runDMC(uint64_t from, uint64_t to) {
+	uint32_t period = DMC_PERIODS[this->dmc.rateIndex];
+
+	uint64_t time = from;
+	while (to - time >= this->dmc.timerCounter) {
+		time += this->dmc.timerCounter;
+		this->dmc.timerCounter = period;
+
+		if (!this->dmc.silence) {
+			if (this->dmc.shiftRegister & 1) {
+				if (this->dmc.outputLevel <= 125) {
+					this->dmc.outputLevel += 2;
+				}
+			} else if (this->dmc.outputLevel >= 2) {
+				this->dmc.outputLevel -= 2;
+			}
+			this->updateOutput(DMC, this->dmc.outputLevel, time);
+		}
+		this->dmc.shiftRegister >>= 1;
+
+		if (--this->dmc.bitsRemaining == 0) {  // The output cycle ends; the next byte is taken from the sample buffer.
+			this->dmc.bitsRemaining = 8;
+			this->dmc.silence = !this->dmc.sampleBufferFull;
+			if (this->dmc.sampleBufferFull) {
+				this->dmc.shiftRegister = this->dmc.sampleBuffer;
+				this->dmc.sampleBufferFull = false;
+				this->fetchDMCSample();
+			}
+		}
+	}
+	this->dmc.timerCounter -= static_cast<uint32_t>(to - time);
+}
+
+void APU::clockFrameStep() {
+	if (!this->fiveStepMode) {
+		this->clockQuarterFrame();
+		if (this->frameStep == 1 || this->frameStep == 3) {
+			this->clockHalfFrame();
+		}
+		if (this->frameStep == 3 && !this->irqInhibit) {
+			this->frameIRQ = true;
+		}
+
+		this->frameStep = (this->frameStep + 1) % 4;
+		if (this->frameStep == 0) {
+			this->frameSequenceStart += FOUR_STEP_PERIOD;
+		}
+		this->nextFrameStepCycle = this->frameSequenceStart + FOUR_STEP_CYCLES[this->frameStep];
+	} else {
+		if (this->frameStep != 3) {  // The 4th step of the 5-step sequence does nothing.
+			this->clockQuarterFrame();
+		}
+		if (this->frameStep == 1 || this->frameStep == 4) {
+			this->clockHalfFrame();
+		}
+
+		this->frameStep = (this->frameStep + 1) % 5;
+		if (this->frameStep == 0) {
+			this->frameSequenceStart += FIVE_STEP_PERIOD;
+		}
+		this->nextFrameStepCycle = this->frameSequenceStart + FIVE_STEP_CYCLES[this->frameStep];
+	}
+}
+
+void APU::clockQuarterFrame() {
+	clockEnvelope(this->pulse[0].envelope);
+	clockEnvelope(this->pulse[1].envelope);
+	clockEnvelope(this->noise.envelope);
+
+	if (this->triangle.linearReload) {
+		this->triangle.linearCounter = this->triangle.linearReloadValue;
+	} else if (this->triangle.linearCounter > 0) {
+		--this->triangle.linearCounter;
+	}
+	if (!this->triangle.control) {
+		this->triangle.linearReload = false;
+	}
+}
+
+void APU::clockHalfFrame() {
+	for (unsigned int i = 0; i < 2; ++i) {
+		PulseState& pulse = this->pulse[i];
+		clockLengthCounter(pulse.lengthCounter, pulse.envelope.loop);
+
+		if (pulse.sweepDivider == 0 && pulse.sweepEnabled && pulse.sweepShift > 0 && !this->isPulseMuted(i)) {
+			pulse.timerPeriod = static_cast<uint16_t>(getSweepTarget(pulse, i));
+		}
+		if (pulse.sweepDivider == 0 || pulse.sweepReload) {
+			pulse.sweepDivider = pulse.sweepPeriod;
+			pulse.sweepReload = false;
+		} else {
+			--pulse.sweepDivider;
+		}
+	}
+	clockLengthCounter(this->triangle.lengthCounter, this->triangle.control);
+	clockLengthCounter(this->noise.lengthCounter, this->noise.envelope.loop);
+}
+
+void APU::restartFrameSequence(uint64_t start) {
+	this->frameSequenceStart = start;
+	this->frameStep = 0;
+	this->nextFrameStepCycle = start + (this->fiveStepMode ? FIVE_STEP_CYCLES[0] : FOUR_STEP_CYCLES[0]);
+}
+
+void APU::fetchDMCSample() {
+	if (this->dmc.sampleBufferFull || this->dmc.bytesRemaining == 0 || this->databus == nullptr) {
+		return;
+	}
+
+	this->dmc.sampleBuffer = this->databus->read(this->dmc.currentAddress);
+	this->dmc.sampleBufferFull = true;
+	this->dmc.currentAddress = this->dmc.currentAddress == 0xffff ? 0x8000 : this->dmc.currentAddress + 1;
+	this->stallCycles += DMC_STALL_CYCLES;
+
+	if (--this->dmc.bytesRemaining == 0) {
+		if (this->dmc.loop) {
+			this->dmc.currentAddress = this->dmc.sampleAddress;
+			this->dmc.bytesRemaining = this->dmc.sampleLength;
+		} else if (this->dmc.irqEnabled) {
+			this->dmcIRQ = true;
+		}
+	}
+}
+
+void APU::updateNextEvent() {
+	this->nextEventCycle = this->nextFrameStepCycle;
+
+	// While there are bytes left, the DMC fetches one at the end of each output cycle (when its buffer is emptied).
+	if (this->dmc.bytesRemaining > 0) {
+		uint64_t outputCycleEnd = this->lastRunCycle + this->dmc.timerCounter +
+								  static_cast<uint64_t>(this->dmc.bitsRemaining - 1) * DMC_PERIODS[this->dmc.rateIndex];
+		this->nextEventCycle = std::min(this->nextEventCycle, outputCycleEnd);
+	}
+}
+
+uint8_t APU::getPulseLevel(unsigned int index) const {
+	const PulseState& pulse = this->pulse[index];
+	if (pulse.lengthCounter == 0 || this->isPulseMuted(index) || !DUTY_SEQUENCES[pulse.duty][pulse.sequenceStep]) {
+		return 0;
+	}
+	return getEnvelopeVolume(pulse.envelope);
+}
+
+uint8_t APU::getTriangleLevel() const {
+	return TRIANGLE_SEQUENCE[this->triangle.sequenceStep];  // Holds its level when stopped instead of going to 0.
+}
+
+uint8_t APU::getNoiseLevel() const {
+	if (this->noise.lengthCounter == 0 || (this->noise.shiftRegister & 1)) {
+		return 0;
+	}
+	return getEnvelopeVolume(this->noise.envelope);
+}
+
+bool APU::isPulseMuted(unsigned int index) const {
+	const PulseState& pulse = this->pulse[index];
+	return pulse.timerPeriod < 8 || getSweepTarget(pulse, index) > 0x7ff;
+}
+
+void APU::updateOutput(Channel channel, uint8_t level, uint64_t atCycle) {
+	if (!this->outputEnabled || level == this->outputLevels[channel]) {
+		return;
+	}
+	float delta = (static_cast<int>(level) - this->outputLevels[channel]) * CHANNEL_WEIGHTS[channel];
+	this->blip.addDelta(static_cast<uint32_t>(atCycle - this->audioFrameStart), delta);
+	this->outputLevels[channel] = level;
+}
+
+void APU::updateAllOutputs(uint64_t atCycle) {
+	this->updateOutput(PULSE_1, this->getPulseLevel(0), atCycle);
+	this->updateOutput(PULSE_2, this->getPulseLevel(1), atCycle);
+	this->updateOutput(TRIANGLE, this->getTriangleLevel(), atCycle);
+	this->updateOutput(NOISE, this->getNoiseLevel(), atCycle);
+	this->updateOutput(DMC, this->dmc.outputLevel, atCycle);
+}
@@ -0,0 +1,187 @@
+// apu.h - The 2A03's audio processing unit: 2 pulse channels, a triangle, noise, the DMC and the frame counter.
+// Registers are at 0x4000 to 0x4013, 0x4015 and 0x4017 (write only; 0x4017 reads go to the second controller).
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "blipBuffer.h"
+
+class DataBus;
+
+constexpr double NTSC_CPU_CLOCK_RATE = 1789772.7272;  // The 236.25 MHz / 11 master clock divided by 12.
+
+struct EnvelopeState {
+	bool start = false;
+	bool loop = false;  // Shares its bit w/ the channel's length counter halt flag.
+	bool constantVolume = false;
+	uint8_t volume = 0;  // The constant volume or the envelope's period.
+	uint8_t divider = 0;
+	uint8_t decay = 0;
+};
+
+struct PulseState {
+	EnvelopeState envelope;
+	uint8_t duty = 0;
+	uint8_t sequenceStep = 0;
+	uint16_t timerPeriod = 0;
+	uint32_t timerCounter = 2;  // CPU cycles until the sequencer steps.
+	uint8_t lengthCounter = 0;
+
+	bool sweepEnabled = false;
+	bool sweepNegate = false;
+	bool sweepReload = false;
+	uint8_t sweepPeriod = 0;
+	uint8_t sweepShift = 0;
+	uint8_t sweepDivider = 0;
+};
+
+struct TriangleState {
+	bool control = false;  // Also halts the length counter.
+	bool linearReload = false;
+	uint8_t linearReloadValue = 0;
+	uint8_t linearCounter = 0;
+	uint8_t sequenceStep = 0;
+	uint16_t timerPeriod = 0;
+	uint32_t timerCounter = 1;
+	uint8_t lengthCounter = 0;
+};
+
+struct NoiseState {
+	EnvelopeState envelope;
+	bool mode = false;  // Short (93 step) sequence.
+	uint8_t periodIndex = 0;
+	uint16_t shiftRegister = 1;
+	uint32_t timerCounter = 4;
+	uint8_t lengthCounter = 0;
+};
+
+struct DMCState {
+	bool irqEnabled = false;
+	bool loop = false;
+	uint8_t rateIndex = 0;
+	uint8_t outputLevel = 0;
+	uint16_t sampleAddress = 0xc000;
+	uint16_t sampleLength = 1;
+
+	uint16_t currentAddress = 0xc000;
+	uint16_t bytesRemaining = 0;
+	uint8_t sampleBuffer = 0;
+	bool sampleBufferFull = false;
+	uint8_t shiftRegister = 0;
+	uint8_t bitsRemaining = 8;
+	bool silence = true;
+	uint32_t timerCounter = 428;
+};
+
+// Every mutable value inside the APU; kept trivially copyable like the CPU and PPU states.
+struct APUState {
+	PulseState pulse[2];
+	TriangleState triangle;
+	NoiseState noise;
+	DMCState dmc;
+	uint8_t channelsEnabled = 0;  // The low 5 bits of 0x4015.
+
+	bool fiveStepMode = false;
+	bool irqInhibit = false;
+	bool frameIRQ = false;
+	bool dmcIRQ = false;
+	uint8_t frameStep = 0;
+	uint64_t nextFrameStepCycle = 7457;
+	uint64_t frameSequenceStart = 0;
+
+	uint64_t cycle = 0;  // CPU cycles clocked since power on.
+	uint64_t lastRunCycle = 0;  // How far the channels have been run.
+	uint64_t nextEventCycle = 7457;  // The first cycle which can not wait for the next register access (see clock).
+	unsigned int stallCycles = 0;  // CPU cycles the DMC's sample fetches still have to steal.
+};
+
+/*
+Channels are run in batches rather than cycle by cycle: the APU only catches up to the current cycle when something needs its
+state (a register access, the end of a frame) or at an event the rest of the NES has to see on time (a frame counter step, which
+may raise the frame IRQ, and the DMC emptying its sample buffer, which makes it fetch the next byte w/ DMA). Within a batch each
+channel jumps from one of its timer clocks to the next, so the cost is per output change instead of per cycle; clock itself is
+just a counter and a comparison.
+
+Output goes through a BlipBuffer. Each channel's level changes are added as steps, mixed w/ the usual linear approximation of
+the NES's mixer (which keeps the channels independent, so each can add its steps whenever it is run).
+
+NOTE: Timing is as exact as the CPU, which executes an instruction all at once, so register writes land on the first cycle of
+their instruction. DMC fetches always stall the CPU for 4 cycles, and the frame IRQ is raised on one cycle instead of three.
+*/
+class APU : protected APUState {
+public:
+	APU();
+	~APU();
+
+	void attachDatabus(DataBus* databus);  // What the DMC reads its samples from; should be the CPU's databus.
+
+	void powerOn();
+	void reset();
+
+	// Called once per CPU cycle.
+	inline void clock() {
+		if (++this->cycle >= this->nextEventCycle) {
+			this->runUntil(this->cycle);
+		}
+	}
+	// Whether the frame counter or the DMC is asserting the IRQ line.
+	inline bool requestingIRQ() const {
+		return this->frameIRQ || this->dmcIRQ;
+	}
+	// Takes one of the cycles the DMC's fetches steal from the CPU; returns false if there are none.
+	inline bool takeStallCycle() {
+		if (this->stallCycles == 0) {
+			return false;
+		}
+		--this->stallCycles;
+		return true;
+	}
+
+	uint8_t readRegister(uint16_t address);  // Only 0x4015 can be read; other addresses return open bus.
+	void writeRegister(uint16_t address, uint8_t value);
+
+	// Makes the audio of everything up to now readable.
+	void endAudioFrame();
+	// Whether the channels' output is added to the audio; when not, time still passes but is silent. Not part of the state.
+	void setOutputEnabled(bool enabled);
+	void setSampleRate(double sampleRate);
+	void setRateAdjustment(double adjustment);  // See BlipBuffer::setRateAdjustment.
+	size_t getSamplesAvailable() const;
+	size_t readSamples(int16_t* out, size_t count);
+
+	const APUState& getState() const;
+	void loadState(const APUState& state);
+
+private:
+	enum Channel { PULSE_1, PULSE_2, TRIANGLE, NOISE, DMC, NUM_CHANNELS };
+
+	void runUntil(uint64_t target);
+	void runPulse(unsigned int index, uint64_t from, uint64_t to);
+	void runTriangle(uint64_t from, uint64_t to);
+	void runNoise(uint64_t from, uint64_t to);
+	void runDMC(uint64_t from, uint64_t to);
+	void clockFrameStep();
+	void clockQuarterFrame();
+	void clockHalfFrame();
+	void restartFrameSequence(uint64_t start);
+	void fetchDMCSample();
+	void updateNextEvent();
+
+	// The channel's current level (0-15, or 0-127 for the DMC).
+	uint8_t getPulseLevel(unsigned int index) const;
+	uint8_t getTriangleLevel() const;
+	uint8_t getNoiseLevel() const;
+	bool isPulseMuted(unsigned int index) const;
+	// Adds a step to the audio if the channel's level at the given cycle is not what was last output.
+	void updateOutput(Channel channel, uint8_t level, uint64_t atCycle);
+	void updateAllOutputs(uint64_t atCycle);
+
+	DataBus* databus;
+
+	// Not part of APUState: these describe the audio already output, not the APU.
+	BlipBuffer blip;
+	uint8_t outputLevels[NUM_CHANNELS];
+	uint64_t audioFrameStart;
+	bool outputEnabled;
+};
@@ -0,0 +1,135 @@
+#include "blipBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	const unsigned int KERNEL_WIDTH = 16;  // Samples each step is spread over.
+	const unsigned int PHASE_BITS = 5;  // Steps are placed w/ 1/32 sample precision.
+	const unsigned int NUM_PHASES = 1 << PHASE_BITS;
+	const double CUTOFF = 0.9;  // Fraction of the output's Nyquist frequency kept.
+	const double HIGH_PASS_HZ = 37.0;  // The lower of the NES's two high-pass filters.
+
+	using Kernel = std::array<std::array<float, KERNEL_WIDTH>, NUM_PHASES>;
+
+	// For each phase (where between 2 samples the step is), the derivative of a band-limited step: a Blackman-windowed sinc.
+	// Each phase is normalized to sum to 1 so a step of delta always ends up exactly delta high.
+	Kernel makeKernel() {
+		const double PI = 3.14159265358979323846;
+		Kernel kernel{};
+		for (unsigned int phase = 0; phase < NUM_PHASES; ++phase) {
+			double fraction = static_cast<double>(phase) / NUM_PHASES;
+			double sum = 0;
+			for (unsigned int i = 0; i < KERNEL_WIDTH; ++i) {
+				double t = i - (KERNEL_WIDTH / 2.0 - 1) - fraction;
+				double x = t * CUTOFF;
+				double sinc = x == 0 ? 1 : std::sin(PI * x) / (PI * x);
+				double u = (t + KERNEL_WIDTH / 2.0) / KERNEL_WIDTH;
+				double window = 0.42 - 0.5 * std::cos(2 * PI * u) + 0.08 * std::cos(4 * PI * u);
+				kernel[phase][i] = static_cast<float>(sinc * window);
+				sum += sinc * window;
+			}
+			for (float& tap : kernel[phase]) {
+				tap = static_cast<float>(tap / sum);
+			}
+		}
+		return kernel;
+	}
+}
+
+BlipBuffer::BlipBuffer(double clockRate, double sampleRate) : rateAdjustment(0), integrator(0), dcLevel(0) {
+	this->setRates(clockRate, sampleRate);
+}
+BlipBuffer::~BlipBuffer() {}
+
+void BlipBuffer::setRates(double clockRate, double sampleRate) {
+	this->clockRate = clockRate;
+	this->sampleRate = sampleRate;
+	this->updateFactor();
+	this->highPass = static_cast<float>(1 - std::exp(-2 * 3.14159265358979323846 * HIGH_PASS_HZ / sampleRate));
+
+	// Room for the capped samples plus as many again for a frame in progress, so even long frames fit.
+	this->capacity = static_cast<size_t>(sampleRate / 4);
+	this->buffer.assign(this->capacity * 2 + KERNEL_WIDTH, 0.0f);
+	this->clear();
+}
+
+double BlipBuffer::getSampleRate() const {
+	return this->sampleRate;
+}
+
+void BlipBuffer::setRateAdjustment(double adjustment) {
+	this->rateAdjustment = adjustment;
+	this->updateFactor();
+}
+
+double BlipBuffer::getRateAdjustment() const {
+	return this->rateAdjustment;
+}
+
+void BlipBuffer::addDelta(uint32_t clockTime, float delta) {
+	static const Kernel KERNEL = makeKernel();
+
+	uint64_t position = this->offset + clockTime * this->factor;
+	size_t sample = static_cast<size_t>(position >> FRAC_BITS);
+	if (sample + KERNEL_WIDTH > this->buffer.size()) {
+		return;  // Only if a frame is far longer than the buffer; the step is lost.
+	}
+
+	const std::array<float, KERNEL_WIDTH>& taps = KERNEL[(position >> (FRAC_BITS - PHASE_BITS)) & (NUM_PHASES - 1)];
+	float* out = this->buffer.data() + sample;
+	for (unsigned int i = 0; i < KERNEL_WIDTH; ++i) {
+		out[i] += taps[i] * delta;
+	}
+}
+
+void BlipBuffer::endFrame(uint32_t frameClocks) {
+	this->offset += frameClocks * this->factor;
+	this->available = static_cast<size_t>(this->offset >> FRAC_BITS);
+
+	if (this->available > this->capacity) {
+		this->removeSamples(nullptr, this->available - this->capacity);
+	}
+}
+
+size_t BlipBuffer::getSamplesAvailable() const {
+	return this->available;
+}
+
+size_t BlipBuffer::readSamples(int16_t* out, size_t count) {
+	count = std::min(count, this->available);
+	this->removeSamples(out, count);
+	return count;
+}
+
+void BlipBuffer::clear() {
+	std::fill(this->buffer.begin(), this->buffer.end(), 0.0f);
+	this->offset = 0;
+	this->available = 0;
+	this->integrator = 0;
+	this->dcLevel = 0;
+}
+
+void BlipBuffer::updateFactor() {
+	double samplesPerClock = this->sampleRate * (1 + this->rateAdjustment) / this->clockRate;
+	this->factor = static_cast<uint64_t>(std::llround(samplesPerClock * static_cast<double>(uint64_t(1) << FRAC_BITS)));
+}
+
+void BlipBuffer::removeSamples(int16_t* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		this->integrator += this->buffer[i];
+		float sample = this->integrator - this->dcLevel;
+		this->dcLevel += sample * this->highPass;
+		if (out != nullptr) {
+			out[i] = static_cast<int16_t>(std::clamp(sample * 32767.0f, -32768.0f, 32767.0f));
+		}
+	}
+
+	// Shifts what is left (including the steps of a frame in progress) to the front.
+	std::memmove(this->buffer.data(), this->buffer.data() + count, (this->buffer.size() - count) * sizeof(float));
+	std::fill(this->buffer.end() - count, this->buffer.end(), 0.0f);
+	this->offset -= static_cast<uint64_t>(count) << FRAC_BITS;
+	this->available -= count;
+}
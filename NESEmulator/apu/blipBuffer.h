@@ -0,0 +1,60 @@
+// blipBuffer.h - Turns a signal given as amplitude changes at clock times into band-limited samples at the output rate.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+Band-limited step synthesis: instead of being sampled, a signal is described by its steps (the APU's channels only ever jump
+between levels) and each step is drawn into the output as a band-limited step, i.e. a step w/ the frequencies above the output's
+Nyquist limit removed. This is what keeps the square waves from aliasing, and it means a channel only costs work when its level
+changes rather than every clock.
+
+The buffer holds the steps' derivative (each step adds a short windowed-sinc kernel); reading integrates it into samples.
+
+Time is in clocks since the start of the current frame. Deltas may be added in any order within a frame; endFrame makes the
+samples before the end of the frame readable and starts the next frame where it ended. Unread samples are capped at about
+1/4 s; the oldest are thrown away past that so a buffer nobody reads from stays bounded.
+*/
+class BlipBuffer {
+public:
+	BlipBuffer(double clockRate, double sampleRate);
+	~BlipBuffer();
+
+	// Changing the rates throws away every sample not read yet.
+	void setRates(double clockRate, double sampleRate);
+	double getSampleRate() const;
+	// Makes each clock produce (1 + adjustment) times as many samples as the rates say, w/o throwing anything away; used to keep
+	// a stream in step w/ an output device whose clock drifts from ours. Takes effect from the next frame.
+	void setRateAdjustment(double adjustment);
+	double getRateAdjustment() const;
+
+	// Adds a step of the given size (in output units; 1.0 = full scale) at the given clock.
+	void addDelta(uint32_t clockTime, float delta);
+	void endFrame(uint32_t frameClocks);
+
+	size_t getSamplesAvailable() const;
+	// Reads up to count samples (mono) and returns the number read.
+	size_t readSamples(int16_t* out, size_t count);
+	void clear();
+
+private:
+	void removeSamples(int16_t* out, size_t count);  // Integrates the first count samples into out (if not nullptr) and drops them.
+	void updateFactor();
+
+	static constexpr unsigned int FRAC_BITS = 32;  // Times are fixed point samples w/ this many fraction bits.
+
+	double clockRate;
+	double sampleRate;
+	double rateAdjustment;
+	uint64_t factor;  // Samples per clock.
+	uint64_t offset;  // Where the current frame starts, in samples since buffer[0].
+	size_t available;
+	size_t capacity;
+
+	std::vector<float> buffer;
+	float integrator;
+	float dcLevel;  // Removed from the output like the NES's own high-pass filters do.
+	float highPass;  // How fast dcLevel follows the signal.
+};
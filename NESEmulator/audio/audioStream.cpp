@@ -0,0 +1,80 @@
+#include "audioStream.h"
+
+#include <algorithm>
+
+namespace {
+	const double FILL_SMOOTHING = 0.05;  // How much of each new fill reading goes into the average; about the last 20 frames count.
+	const double INTEGRAL_GAIN = 0.01;  // How much of the error is added to the accumulated correction each frame.
+}
+
+AudioStream::AudioStream(size_t targetFill, size_t capacity, double maxAdjustment) :
+	ring(std::max(capacity, targetFill * 2)),
+	targetFill(std::max<size_t>(targetFill, 1)),
+	maxAdjustment(maxAdjustment),
+	averageFill(static_cast<double>(targetFill)),
+	accumulatedAdjustment(0),
+	lastSample(0),
+	playing(false),
+	underruns(0),
+	overruns(0),
+	samplesDropped(0),
+	rateAdjustment(0)
+{}
+AudioStream::~AudioStream() {}
+
+void AudioStream::write(const int16_t* samples, size_t count) {
+	size_t written = this->ring.write(samples, count);
+	if (written < count) {
+		this->overruns.fetch_add(1, std::memory_order_relaxed);
+		this->samplesDropped.fetch_add(count - written, std::memory_order_relaxed);
+	}
+}
+
+double AudioStream::getRateAdjustment() {
+	this->averageFill += (static_cast<double>(this->ring.getSize()) - this->averageFill) * FILL_SMOOTHING;
+
+	// A correction proportional to how far the fill is from the target (+maxAdjustment when empty, -maxAdjustment at twice the 
+	// target or more), plus the accumulated error. The proportional part alone would settle w/ the fill short of the target by 
+	// however much it takes to cancel the drift; the accumulated part takes that over so the fill ends up at the target.
+	double error = std::clamp((static_cast<double>(this->targetFill) - this->averageFill) / static_cast<double>(this->targetFill), -1.0, 1.0);
+	this->accumulatedAdjustment = std::clamp(this->accumulatedAdjustment + error * this->maxAdjustment * INTEGRAL_GAIN, -this->maxAdjustment, this->maxAdjustment);
+	double adjustment = std::clamp(error * this->maxAdjustment + this->accumulatedAdjustment, -this->maxAdjustment, this->maxAdjustment);
+
+	this->rateAdjustment.store(adjustment, std::memory_order_relaxed);
+	return adjustment;
+}
+
+void AudioStream::pause() {
+	this->playing.store(false, std::memory_order_relaxed);
+}
+
+void AudioStream::read(int16_t* out, size_t count) {
+	if (!this->playing.load(std::memory_order_relaxed)) {
+		if (this->ring.getSize() < this->targetFill) {
+			std::fill(out, out + count, static_cast<int16_t>(0));
+			return;
+		}
+		this->playing.store(true, std::memory_order_relaxed);
+	}
+
+	size_t read = this->ring.read(out, count);
+	if (read > 0) {
+		this->lastSample = out[read - 1];
+	}
+	if (read < count) {
+		this->underruns.fetch_add(1, std::memory_order_relaxed);
+		std::fill(out + read, out + count, this->lastSample);
+	}
+}
+
+AudioStreamStats AudioStream::getStats() const {
+	AudioStreamStats stats;
+	stats.bufferFill = this->ring.getSize();
+	stats.capacity = this->ring.getCapacity();
+	stats.targetFill = this->targetFill;
+	stats.underruns = this->underruns.load(std::memory_order_relaxed);
+	stats.overruns = this->overruns.load(std::memory_order_relaxed);
+	stats.samplesDropped = this->samplesDropped.load(std::memory_order_relaxed);
+	stats.rateAdjustment = this->rateAdjustment.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,73 @@
+// audioStream.h - Carries the APU's samples from the emulation thread to an audio device's callback and keeps the two in step.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../globals/spscRingBuffer.hpp"
+
+// Counters to tell whether the audio device is being kept fed.
+struct AudioStreamStats {
+	size_t bufferFill = 0;  // Samples queued when the stats were taken.
+	size_t capacity = 0;
+	size_t targetFill = 0;
+	unsigned long long underruns = 0;  // Times the device asked for more samples than were queued.
+	unsigned long long overruns = 0;  // Times samples were thrown away because the queue was full.
+	unsigned long long samplesDropped = 0;  // Samples thrown away in those overruns.
+	double rateAdjustment = 0;  // The last adjustment handed out by getRateAdjustment.
+};
+
+/*
+The emulation thread writes each frame's samples and the device's callback reads them, through an SPSCRingBuffer, so neither ever
+waits on the other (and the callback, which runs on the audio thread, never takes a lock).
+
+The emulation runs at whatever pace SpeedControl keeps and the device plays at its own clock, and the two never quite agree, so
+a queue fed at a fixed rate slowly fills up (adding latency until it overruns) or drains (until it underruns). Dynamic rate control
+fixes this: once a frame the writer asks getRateAdjustment for a correction and passes it to NES::setAudioRateAdjustment, which
+makes the APU produce slightly more samples when the queue is below its target fill and slightly fewer when it is above. The
+correction is at most maxAdjustment (0.5% by default), which is too small to hear as a change in pitch but more than enough to
+make up for the clocks drifting apart.
+
+On an underrun the last sample is repeated to fill the gap. Until the queue is first filled to its target (the device is usually
+started before the emulation) and after the writer calls pause (e.g. while fast-forwarding, when there is nothing worth playing),
+the reader plays silence instead and nothing is counted as an underrun.
+*/
+class AudioStream {
+public:
+	AudioStream(size_t targetFill, size_t capacity, double maxAdjustment = 0.005);
+	~AudioStream();
+
+	// --- Writer (the emulation thread) --- //
+
+	void write(const int16_t* samples, size_t count);
+	// The rate adjustment to produce the next frame's samples w/, based on how full the queue has been lately.
+	double getRateAdjustment();
+	// Stops playing until the queue has been filled up to the target again.
+	void pause();
+
+	// --- Reader (the audio device) --- //
+
+	// Always fills out w/ count samples; see above for what happens when there are not enough.
+	void read(int16_t* out, size_t count);
+
+	// --- Either thread --- //
+
+	AudioStreamStats getStats() const;
+
+private:
+	SPSCRingBuffer<int16_t> ring;
+	size_t targetFill;
+	double maxAdjustment;
+
+	double averageFill;  // Writer only. The fill smoothed over several frames, since it jumps by a whole callback's worth at a time.
+	double accumulatedAdjustment;  // Writer only. See getRateAdjustment.
+
+	int16_t lastSample;  // Reader only.
+	std::atomic<bool> playing;  // Set by the reader once the queue reaches its target fill; cleared by pause.
+
+	std::atomic<unsigned long long> underruns;
+	std::atomic<unsigned long long> overruns;
+	std::atomic<unsigned long long> samplesDropped;
+	std::atomic<double> rateAdjustment;
+};
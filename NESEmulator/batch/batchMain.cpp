@@ -0,0 +1,100 @@
+// batchMain.cpp - NESBatch: runs every job in a job list (see batchRunner.h) w/o a window, one NES per job across every core.
+#include "batchRunner.h"
+
+#include "../globals/workStealingPool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+	void printUsage() {
+		std::cout << "Usage: NESBatch <job list> [--threads N]" << std::endl;
+		std::cout << "Runs each job in the list on a NES of its own, as many at once as there are threads (every core by default)," << std::endl;
+		std::cout << "and reports how fast each one ran. See batch/batchRunner.h for the job list's format." << std::endl;
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* jobListPath = nullptr;
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			numThreads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		} else if (jobListPath == nullptr && argv[i][0] != '-') {
+			jobListPath = argv[i];
+		} else {
+			printUsage();
+			return 2;
+		}
+	}
+	if (jobListPath == nullptr) {
+		printUsage();
+		return 2;
+	}
+
+	std::ifstream jobList{ jobListPath };
+	if (!jobList) {
+		std::cout << "Can't open job list " << jobListPath << std::endl;
+		return 2;
+	}
+	std::vector<std::string> errors;
+	std::vector<BatchJob> jobs = parseJobList(jobList, errors);
+	for (const std::string& error : errors) {
+		std::cout << jobListPath << ", " << error << std::endl;
+	}
+	if (!errors.empty()) {
+		return 2;
+	}
+
+	std::vector<BatchJobResult> results(jobs.size());
+	std::mutex outputMutex;  // So the lines of jobs finishing at once are not interleaved.
+	auto start = std::chrono::steady_clock::now();
+	{
+		WorkStealingPool pool{ numThreads };
+		std::cout << "Running " << jobs.size() << " jobs on " << pool.getThreadCount() << " threads." << std::endl;
+
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			pool.submit([&jobs, &results, &outputMutex, i]() {
+				BatchJobResult result = runBatchJob(jobs[i]);
+				results[i] = result;
+
+				std::lock_guard<std::mutex> lock{ outputMutex };
+				std::cout << "line " << jobs[i].line << " (" << jobs[i].rom << "): ";
+				if (!result.succeeded) {
+					std::cout << "FAILED, " << result.error << std::endl;
+					return;
+				}
+				std::cout << result.framesEmulated << " frames in " << std::fixed << std::setprecision(2) << result.seconds << " s, "
+					<< std::setprecision(1) << result.getFramesPerSecond() << " frames/s (" << result.getSpeedMultiplier() << "x realtime)";
+				if (result.firstDesync >= 0) {
+					std::cout << ", DESYNCED at frame " << result.firstDesync;
+				}
+				std::cout << std::defaultfloat << std::endl;
+			});
+		}
+		pool.wait();
+
+		unsigned long long totalFrames = 0;
+		size_t failed = 0, desynced = 0;
+		for (const BatchJobResult& result : results) {
+			totalFrames += result.framesEmulated;
+			failed += !result.succeeded;
+			desynced += result.succeeded && result.firstDesync >= 0;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << jobs.size() << " jobs (" << failed << " failed, " << desynced << " desynced), " << totalFrames << " frames in "
+			<< std::fixed << std::setprecision(2) << seconds << " s: " << std::setprecision(1) << (seconds > 0 ? totalFrames / seconds : 0)
+			<< " frames/s over all threads, " << pool.getSteals() << " jobs stolen." << std::endl;
+
+		if (failed != 0 || desynced != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
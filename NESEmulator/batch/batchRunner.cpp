@@ -0,0 +1,238 @@
+#include "batchRunner.h"
+
+#include "../nesSystem.h"
+#include "../recording/audioSink.h"
+#include "../recording/frameSink.h"
+#include "../recording/movie.h"
+#include "../timing/framePacer.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+
+namespace {
+	// Splits a line into its key=value pairs, stopping at a #. Returns false (w/ error set) if a pair is malformed.
+	bool splitJobLine(const std::string& line, std::vector<std::pair<std::string, std::string>>& pairs, std::string& error) {
+		size_t i = 0;
+		while (i < line.size()) {
+			if (std::isspace(static_cast<unsigned char>(line[i]))) {
+				++i;
+				continue;
+			}
+			if (line[i] == '#') {
+				break;
+			}
+
+			size_t equals = line.find('=', i);
+			size_t space = i;
+			while (space < line.size() && !std::isspace(static_cast<unsigned char>(line[space]))) {
+				++space;
+			}
+			if (equals == std::string::npos || equals >= space || equals == i) {
+				error = "expected key=value, got \"" + line.substr(i, space - i) + "\"";
+				return false;
+			}
+
+			std::string key = line.substr(i, equals - i);
+			std::string value;
+			i = equals + 1;
+			if (i < line.size() && line[i] == '"') {
+				size_t close = line.find('"', i + 1);
+				if (close == std::string::npos) {
+					error = "unterminated quote in " + key;
+					return false;
+				}
+				value = line.substr(i + 1, close - i - 1);
+				i = close + 1;
+			} else {
+				while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i]))) {
+					value.push_back(line[i]);
+					++i;
+				}
+			}
+			pairs.emplace_back(key, value);
+		}
+		return true;
+	}
+}
+
+double BatchJobResult::getFramesPerSecond() const {
+	return this->seconds > 0 ? this->framesEmulated / this->seconds : 0;
+}
+
+double BatchJobResult::getSpeedMultiplier() const {
+	return this->getFramesPerSecond() / NTSC_FRAME_RATE;
+}
+
+std::vector<BatchJob> parseJobList(std::istream& input, std::vector<std::string>& errors) {
+	std::vector<BatchJob> jobs;
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(input, line)) {
+		++lineNumber;
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+
+		std::vector<std::pair<std::string, std::string>> pairs;
+		std::string error;
+		if (!splitJobLine(line, pairs, error)) {
+			errors.push_back("line " + std::to_string(lineNumber) + ": " + error);
+			continue;
+		}
+		if (pairs.empty()) {
+			continue;
+		}
+
+		BatchJob job;
+		job.line = lineNumber;
+		for (const auto& [key, value] : pairs) {
+			if (key == "rom") {
+				job.rom = value;
+			} else if (key == "movie") {
+				job.movie = value;
+			} else if (key == "frames") {
+				char* end = nullptr;
+				job.frames = std::strtoull(value.c_str(), &end, 10);
+				if (value.empty() || *end != '\0' || job.frames == 0) {
+					error = "frames must be a positive number, got \"" + value + "\"";
+				}
+			} else if (key == "framehash") {
+				job.frameHashPath = value;
+			} else if (key == "audiohash") {
+				job.audioHashPath = value;
+			} else if (key == "video") {
+				job.videoPath = value;
+			} else if (key == "state") {
+				job.statePath = value;
+			} else {
+				error = "unknown key \"" + key + "\"";
+			}
+		}
+		if (error.empty() && job.rom.empty()) {
+			error = "no rom given";
+		}
+		if (error.empty() && job.movie.empty() && job.frames == 0) {
+			error = "frames must be given when there is no movie";
+		}
+
+		if (error.empty()) {
+			jobs.push_back(job);
+		} else {
+			errors.push_back("line " + std::to_string(lineNumber) + ": " + error);
+		}
+	}
+	return jobs;
+}
+
+BatchJobResult runBatchJob(const BatchJob& job) {
+	BatchJobResult result;
+	auto start = std::chrono::steady_clock::now();
+	auto finish = [&result, start](const std::string& error) {
+		result.error = error;
+		result.succeeded = error.empty();
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	};
+
+	// NOTE: loadROM only prints when it fails, so check the file can be read first to report it properly.
+	if (!std::ifstream{ job.rom, std::ios::binary }) {
+		return finish("can't open ROM " + job.rom);
+	}
+	// A NES is a few hundred KB (mostly its frame buffer and memory), too much for a worker thread's stack.
+	std::unique_ptr<NESSystem> nes = std::make_unique<NESSystem>();
+	nes->loadROM(job.rom.c_str());
+	nes->powerOn();
+	nes->queueButtons(0, 0);  // Nothing is held unless the movie says so.
+
+	MoviePlayer player;
+	bool hasMovie = !job.movie.empty();
+	if (hasMovie) {
+		MovieResult::MovieResult movieResult = player.open(job.movie);
+		if (movieResult == MovieResult::SUCCESS) {
+			movieResult = player.seek(*nes, 0);
+		}
+		if (movieResult != MovieResult::SUCCESS) {
+			return finish("can't play movie " + job.movie + " (error " + std::to_string(movieResult) + ")");
+		}
+	}
+	unsigned long long frames = job.frames != 0 ? job.frames : player.getFrameCount();
+
+	std::ofstream frameHashes;
+	if (!job.frameHashPath.empty()) {
+		frameHashes.open(job.frameHashPath);
+		if (!frameHashes) {
+			return finish("can't open " + job.frameHashPath);
+		}
+		frameHashes << std::hex << std::setfill('0');
+	}
+	std::unique_ptr<AudioSink> audio;
+	if (!job.audioHashPath.empty()) {
+		audio = std::make_unique<AudioSink>(AudioFormat::NONE, "", 48000, job.audioHashPath);
+		if (!audio->isOpen()) {
+			return finish("can't open " + job.audioHashPath);
+		}
+	}
+	std::unique_ptr<FrameSink> video;
+	if (!job.videoPath.empty()) {
+		video = std::make_unique<FrameSink>(FrameFormat::Y4M, job.videoPath, nes->getPPU().getPaletteLUT());
+		if (!video->isOpen()) {
+			return finish("can't open " + job.videoPath);
+		}
+	}
+
+	// Composing the picture and mixing audio are a good part of a frame's time, so skip them when nothing uses them.
+	nes->setVideoOutput(frameHashes.is_open() || video);
+	nes->setAudioOutput(static_cast<bool>(audio));
+	std::vector<int16_t> samples;
+
+	bool movieEnded = !hasMovie;
+	for (unsigned long long frame = 0; frame < frames; ++frame) {
+		if (!movieEnded && !player.playFrame(*nes)) {
+			movieEnded = true;
+			nes->queueButtons(nes->getTotalMachineCycles(), 0);
+		}
+		if (nes->executeFrame() == FAIL_CYCLE) {
+			result.framesEmulated = frame;
+			return finish("the CPU failed on frame " + std::to_string(frame));
+		}
+
+		if (frameHashes.is_open()) {
+			frameHashes << std::dec << frame << ' ' << std::hex << std::setw(16) << nes->getFrameBuffer().getFrameHash() << '\n';
+		}
+		if (video) {
+			video->submit(nes->getFrameBuffer(), true);
+		}
+		if (audio) {
+			samples.resize(nes->getAudioSamplesAvailable());
+			samples.resize(nes->readAudioSamples(samples.data(), samples.size()));
+			audio->submitFrame(samples.data(), samples.size());
+		}
+	}
+	result.framesEmulated = frames;
+	result.firstDesync = player.getFirstDesync();
+
+	if (!job.statePath.empty() && nes->saveStateToFile(job.statePath.c_str()) != SaveStateResult::SUCCESS) {
+		return finish("can't save state to " + job.statePath);
+	}
+	// NOTE: A write which fails while the sinks finish their queues (below) is not caught; only the files' ends would be missing.
+	if (video && video->getStats().writeFailed) {
+		return finish("failed writing " + job.videoPath);
+	}
+	if (audio && audio->getStats().writeFailed) {
+		return finish("failed writing " + job.audioHashPath);
+	}
+	// The sinks write what is still queued when they are destroyed, which counts towards the job's time.
+	video.reset();
+	audio.reset();
+	if (frameHashes.is_open()) {
+		frameHashes.close();
+		if (!frameHashes) {
+			return finish("failed writing " + job.frameHashPath);
+		}
+	}
+	return finish("");
+}
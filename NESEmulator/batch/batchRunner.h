@@ -0,0 +1,49 @@
+// batchRunner.h - Reads job lists for NESBatch and runs a single job (a ROM, optionally a movie, and what to write out).
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+/*
+FORMAT: one job per line, as key=value pairs separated by whitespace. Values w/ spaces in them go in double quotes. Blank lines and
+anything after a # are ignored.
+
+	rom=<path>        The iNES file to run. Required.
+	movie=<path>      A movie (see movie.h) to play the buttons of; w/o one, no buttons are pressed.
+	frames=<count>    How many frames to emulate. Defaults to the movie's length; after the movie ends no buttons are pressed.
+	framehash=<path>  Writes a line per frame w/ its number and the hash of its picture (see IndexedFrameBuffer::getFrameHash).
+	audiohash=<path>  Writes a line per frame w/ the hash of its audio (see AudioSink).
+	video=<path>      Writes every frame to a Y4M file; nothing is dropped, so this can be slow.
+	state=<path>      Saves the NES's state after the last frame.
+
+e.g.
+	rom=testROMS/smb.nes movie=runs/smb.nesm framehash=out/smb.hash  # Check a movie against a known good build.
+	rom=testROMS/dk.nes frames=36000 state="out/dk 10min.sav"
+
+The frame and audio hashes are the same from run to run and machine to machine, so two builds can be compared by diffing them.
+*/
+struct BatchJob {
+	unsigned int line = 0;  // Where in the job list the job is, for reporting.
+	std::string rom;
+	std::string movie;  // Empty if there is none.
+	unsigned long long frames = 0;  // 0 means the movie's length.
+	std::string frameHashPath, audioHashPath, videoPath, statePath;  // Empty for outputs which are not wanted.
+};
+
+struct BatchJobResult {
+	bool succeeded = false;  // Whether everything was run and written; if not, error says why.
+	std::string error;
+	unsigned long long framesEmulated = 0;
+	double seconds = 0;  // Wall clock time the job took, including loading and writing its outputs.
+	long long firstDesync = -1;  // See MoviePlayer::getFirstDesync.
+
+	double getFramesPerSecond() const;
+	double getSpeedMultiplier() const;  // How many times faster than a real NES.
+};
+
+// Reads every job in the list. Lines which can not be read are described in errors (w/ their line numbers) and skipped.
+std::vector<BatchJob> parseJobList(std::istream& input, std::vector<std::string>& errors);
+
+// Runs the job on a NES of its own. Jobs share nothing, so any number of them may run at once on different threads.
+BatchJobResult runBatchJob(const BatchJob& job);
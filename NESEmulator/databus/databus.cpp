@@ -22,6 +22,10 @@ uint8_t DataBus::read(uint16_t address) {
 uint8_t DataBus::write(uint16_t address, uint8_t value) {
 	return this->memory->setByte(address, value);
 }
+
+void DataBus::readBlock(uint16_t address, uint8_t* out, size_t count) {
+	this->memory->getBytes(address, out, count);
+}
 /*
 uint8_t DataBus::pullStack(uint8_t& stackPtr) {
 	// The stack pointer currently points to the address above
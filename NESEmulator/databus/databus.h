@@ -2,6 +2,7 @@
 // Provides an interface to read and write memory.
 #pragma once
 #include <cstdint>
+#include <cstddef>
 
 // Inclusive
 constexpr unsigned int STACK_START_ADDR = 0x1FF;
@@ -22,6 +23,9 @@ public:
 	// Basic, fundamental read/write operations.
 	virtual uint8_t read(uint16_t address);  // Returns the memory located at that address.
 	virtual uint8_t write(uint16_t address, uint8_t value);  // Returns the old value at the given spot.
+	// Reads count bytes starting at address straight from memory, skipping anything a child's read does; only valid for 
+	// addresses which are mapped to plain memory.
+	void readBlock(uint16_t address, uint8_t* out, size_t count);
 
 private:
 	Memory* memory;
@@ -1,12 +1,13 @@
 #include "nesDatabus.h"
 #include "../input/inputPort.h"
 
+#include <cstring>
 #include <iostream>
 
 // TODO: Support player 2.
 
 //NESDatabus::NESDatabus() : DataBus(), ram(nullptr), ppu(nullptr) {}
-NESDatabus::NESDatabus(Memory* memory, RAM* ram, PPU* ppu) : DataBus(memory), ram(ram), ppu(ppu) {}
+NESDatabus::NESDatabus(Memory* memory, RAM* ram, PPU* ppu) : DataBus(memory), ram(ram), ppu(ppu), input_port(nullptr), apu(nullptr) {}
 NESDatabus::~NESDatabus() {}
 
 void NESDatabus::attach(RAM* ram) {
@@ -25,6 +26,10 @@ void NESDatabus::attach(InputPort* input_port) {
 	this->input_port = input_port;
 }
 
+void NESDatabus::attach(APU* apu) {
+	this->apu = apu;
+}
+
 uint8_t NESDatabus::read(uint16_t address) {
 	// First, check if the address is within the RAM address space.
 	AddressingSpace::AddressingSpace addrSpace = getAddressingSpace(address);
@@ -38,6 +43,9 @@ uint8_t NESDatabus::read(uint16_t address) {
 	case(AddressingSpace::PPU_REGISTERS):
 		return this->ppu->readRegister(address);
 		break;
+	case(AddressingSpace::APU_REGISTERS):
+		return this->apu->readRegister(address);
+		break;
 	case(AddressingSpace::INPUT_REGISTERS):
 		return 0x40 | this->input_port->readAndClock();  // The upper 3 bits returned is open bus, which is USUALLY 0b010, so the output is usually 0b0100'000N.
 		break;
@@ -61,8 +69,16 @@ uint8_t NESDatabus::write(uint16_t address, uint8_t value) {
 	case(AddressingSpace::PPU_REGISTERS):
 		return this->ppu->writeToRegister(address, value);
 		break;
+	case(AddressingSpace::APU_REGISTERS):
+		this->apu->writeRegister(address, value);
+		return value;
+		break;
 	case(AddressingSpace::INPUT_REGISTERS):
-		this->input_port->setLatch(value & 0b1);  // Sets the latch associated w/ the input port to value of the first bit.
+		if (address == 0x4016) {
+			this->input_port->setLatch(value & 0b1);  // Sets the latch associated w/ the input port to value of the first bit.
+		} else {  // Reading 0x4017 reads the second controller, but writing to it controls the APU's frame counter.
+			this->apu->writeRegister(address, value);
+		}
 		return 0;
 		break;
 	default:
@@ -73,11 +89,25 @@ uint8_t NESDatabus::write(uint16_t address, uint8_t value) {
 	
 }
 
+bool NESDatabus::readPage(uint8_t page, uint8_t* out) {
+	uint16_t address = static_cast<uint16_t>(page) << 8;
+	if (address < RAM_ADDRESSES) {
+		std::memcpy(out, this->ram->getData() + (address & RAM::ADDRESS_MASK), 0x100);  // A page never straddles a mirror.
+		return true;
+	} else if (address > 0x4000) {  // The 0x40 page holds the APU and input registers.
+		DataBus::readBlock(address, out, 0x100);
+		return true;
+	}
+	return false;
+}
+
 AddressingSpace::AddressingSpace getAddressingSpace(uint16_t address) {
 	if (address < 0x2000) {
 		return AddressingSpace::RAM;
 	} else if ((address >= 0x2000 && address < 0x2008) || address == 0x4014) {  // TODO: Implement the PPU registers located in the 0x4000s
 		return AddressingSpace::PPU_REGISTERS;
+	} else if ((address >= 0x4000 && address <= 0x4013) || address == 0x4015) {
+		return AddressingSpace::APU_REGISTERS;
 	} else if (address == 0x4016 || address == 0x4017) {
 		return AddressingSpace::INPUT_REGISTERS;
 	} else {
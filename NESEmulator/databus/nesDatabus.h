@@ -4,6 +4,7 @@
 #include "databus.h"
 #include "../memory/ram.h"
 #include "../ppu/ppu.h"
+#include "../apu/apu.h"
 
 class InputPort;
 
@@ -14,6 +15,7 @@ namespace AddressingSpace {
 		MEMORY,  // Standard memory as mapped by the cartridge.
 		RAM,  // The 2kb of RAM on the NES (0x000 to 0x800 inclusive; mirrored up to and including 0x1fff)
 		PPU_REGISTERS,  // The 8 addresses (0x2000 to 0x2007 inclusive; mirrored up to and including 0x3fff) involved w/ the PPU.
+		APU_REGISTERS,  // 0x4000 to 0x4013 inclusive and 0x4015 (0x4017 is shared w/ the second controller; see NESDatabus::write).
 		INPUT_REGISTERS  // The 2 addresses, 0x4016 and 0x4017, which deal w/ controller input.
 	};
 }
@@ -30,12 +32,19 @@ public:
 	void attach(Memory* memory);
 	void attach(PPU* ppu);
 	void attach(InputPort* input_port);
+	void attach(APU* apu);
 
 	virtual uint8_t read(uint16_t address) override;  // Returns the memory located at that address.
 	virtual uint8_t write(uint16_t address, uint8_t value) override;  // Returns the value just written (NOTE: might change this to the previous data value).
 
+	// Copies the 256 bytes of a page into out at once if the page is plain memory (RAM, or memory mapped by the cartridge), which
+	// is the same as reading each byte. Returns false and copies nothing if there are registers on the page, since reading those
+	// has side effects.
+	bool readPage(uint8_t page, uint8_t* out);
+
 private:
 	RAM* ram;
 	PPU* ppu;  
 	InputPort* input_port;
+	APU* apu;
 };
\ No newline at end of file
@@ -6,7 +6,7 @@ PPUDatabus::PPUDatabus() {
 PPUDatabus::~PPUDatabus() {
 }
 
-void PPUDatabus::attachVRAM(Memory* vram) {
+void PPUDatabus::attachVRAM(VideoRAM* vram) {
 	this->VRAM = vram;
 }
 
@@ -14,52 +14,38 @@ void PPUDatabus::attachCHRDATA(Memory* chrData) {
 	this->CHRDATA = chrData;
 }
 
-void PPUDatabus::attachPalette(Memory* paletteRAM) {
+void PPUDatabus::attachPalette(PaletteRAM* paletteRAM) {
 	this->paletteControl = paletteRAM;
 }
 
-uint8_t PPUDatabus::read(uint16_t address) {
-	Memory* memory = this->getMemoryModule(address);
-	this->adjustAddress(address);
-	return memory->getByte(address);
-}
-
-uint8_t PPUDatabus::write(uint16_t address, uint8_t value) {
-	Memory* memory = this->getMemoryModule(address);
-	this->adjustAddress(address);
-	return memory->setByte(address, value);
-}
-
-void PPUDatabus::adjustAddress(uint16_t& address) {
-	const uint16_t PALETTE_RAM_ADDR = 0x3f00, PALETTE_SIZE = 0x20;
-	const uint16_t NAMETABLES_ADDR = 0x2000, NAMETABLES_SIZE = 0x1000;  // Note: This is the size of all nametables combined.
-	const uint16_t PATTERN_TABLES_ADDR = 0x0000, PATTERN_TABLES_SIZE = 0x2000;  // Note: Size of both pattern tables combined.
+// NOTE: Address space layout; pattern tables at 0x0000-0x1fff, nametables at 0x2000-0x3eff, palette RAM at 0x3f00-0x3fff.
+// VRAM and palette RAM are fixed-size modules which mirror themselves, so only CHRDATA and the palette need adjusting.
+const uint16_t PALETTE_RAM_ADDR = 0x3f00;
+const uint16_t NAMETABLES_ADDR = 0x2000;
+const uint16_t PATTERN_TABLES_SIZE = 0x2000;  // Note: Size of both pattern tables combined.
 
+uint8_t PPUDatabus::read(uint16_t address) {
 	if (address >= PALETTE_RAM_ADDR) {
-		address %= PALETTE_SIZE;
-		// Note that the first index of each palette is shared between sprites and the background.
-		// Checks if were looking at the first index.
-		if ((address & 0b11) == 0) address |= 0b1'0000;
+		return this->paletteControl->getByte(this->adjustPaletteAddress(address));
 	} else if (address >= NAMETABLES_ADDR) {
-		address %= NAMETABLES_SIZE;
-	} else {
-		address %= PATTERN_TABLES_SIZE;
+		return this->VRAM->getByte(address);
 	}
+	return this->CHRDATA->getByte(address % PATTERN_TABLES_SIZE);
 }
 
-Memory* PPUDatabus::getMemoryModule(uint16_t address) {
-	const uint16_t PALETTE_RAM_ADDR = 0x3f00, PALETTE_SIZE = 0x20;
-	const uint16_t NAMETABLES_ADDR = 0x2000, NAMETABLES_ADDR_SIZE = 0x1000;  // Note: This is the size of all nametables combined.
-	const uint16_t PATTERN_TABLES_ADDR = 0x0000, PATTERN_TABLES_SIZE = 0x2000;  // Note: Size of both pattern tables combined.
-
+uint8_t PPUDatabus::write(uint16_t address, uint8_t value) {
 	if (address >= PALETTE_RAM_ADDR) {
-		return this->paletteControl;
-	}
-	else if (address >= NAMETABLES_ADDR) {
-		return this->VRAM;
-	}
-	else {
-		return this->CHRDATA;
+		return this->paletteControl->setByte(this->adjustPaletteAddress(address), value);
+	} else if (address >= NAMETABLES_ADDR) {
+		return this->VRAM->setByte(address, value);
 	}
+	return this->CHRDATA->setByte(address % PATTERN_TABLES_SIZE, value);
+}
 
+uint16_t PPUDatabus::adjustPaletteAddress(uint16_t address) {
+	address &= PALETTE_RAM_SIZE - 1;
+	// Note that the first index of each palette is shared between sprites and the background.
+	// Checks if were looking at the first index.
+	if ((address & 0b11) == 0) address |= 0b1'0000;
+	return address;
 }
@@ -3,27 +3,33 @@
 
 #include "databus.h"
 #include "../memory/memory.h"
+#include "../memory/fixedMemory.hpp"
 //#include "../ppu/ppu.h"
 
+const int VRAM_SIZE = 0x800;  // The size of the internal VRAM that the NES has in bytes.
+const int PALETTE_RAM_SIZE = 0x20;
+
+using VideoRAM = FixedMemory<VRAM_SIZE>;
+using PaletteRAM = FixedMemory<PALETTE_RAM_SIZE>;
+
 class PPUDatabus : public DataBus {
 public:
 	PPUDatabus();
 	~PPUDatabus();
 
 	// Sets the internal pointer to a Memory module to the given pointer.
-	void attachVRAM(Memory* vram);
+	void attachVRAM(VideoRAM* vram);
 	void attachCHRDATA(Memory* chrData);
-	void attachPalette(Memory* paletteRAM);
+	void attachPalette(PaletteRAM* paletteRAM);
 	
 	// Basic, fundamental read/write operations.
 	virtual uint8_t read(uint16_t address) override;  // Returns the memory located at that address.
 	virtual uint8_t write(uint16_t address, uint8_t value) override;  // Returns the old value at the given spot.
 
 private:
-	void adjustAddress(uint16_t& address);  // Adjusts the address to make it within range of the memory module it maps to.
-	Memory* getMemoryModule(uint16_t address);  // Gets the pointer to the relevant memory module given an address
+	uint16_t adjustPaletteAddress(uint16_t address);  // Adjusts a palette address to make it within range of palette RAM.
 
-	Memory* VRAM;  
+	VideoRAM* VRAM;  
 	Memory* CHRDATA;  
-	Memory* paletteControl;
+	PaletteRAM* paletteControl;
 };
\ No newline at end of file
@@ -2,7 +2,6 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
-#include <minmax.h>
 #include <sstream>
 #include "../memory/memory.h"
 #include "../input/cmdInput.h"
@@ -34,16 +33,7 @@ bool CPUDebugger::pcAt(uint16_t address) {
 
 CPUInternals CPUDebugger::getInternals() const {
 	CPUInternals internals;
-	internals.registers = this->registers;
-	internals.interruptRequested = this->interruptRequested;
-	internals.performInterrupt = this->performInterrupt;
-	internals.nmiRequested = this->nmiRequested;
-	internals.lastNMISignal = this->lastNMISignal;
-	internals.getOrPutCycle = this->getOrPutCycle;
-	internals.totalCyclesElapsed = this->totalCyclesElapsed;
-	internals.opcodeCyclesElapsed = this->opcodeCyclesElapsed;
-	internals.currentOpcodeCycleLen = this->currentOpcodeCycleLen;
-	internals.performNMI = this->performNMI;
+	static_cast<CPUState&>(internals) = this->getState();
 
 	return internals;
 }
@@ -54,16 +44,7 @@ void CPUDebugger::attach(DataBus* databus) {
 }
 
 void CPUDebugger::loadInternals(CPUInternals cpuInternals) {
-	this->registers = cpuInternals.registers;
-	this->interruptRequested = cpuInternals.interruptRequested;
-	this->performInterrupt = cpuInternals.performInterrupt;
-	this->nmiRequested = cpuInternals.nmiRequested;
-	this->lastNMISignal = cpuInternals.lastNMISignal;
-	this->getOrPutCycle = cpuInternals.getOrPutCycle;
-	this->totalCyclesElapsed = cpuInternals.totalCyclesElapsed;
-	this->opcodeCyclesElapsed = cpuInternals.opcodeCyclesElapsed;
-	this->currentOpcodeCycleLen = cpuInternals.currentOpcodeCycleLen;
-	this->performNMI = cpuInternals.performNMI;
+	this->loadState(cpuInternals);
 }
 
 uint64_t CPUDebugger::getNumCycles() const {
@@ -274,25 +274,11 @@ const std::map<uint8_t, std::string> OPCODE_TO_NAME = {
 {0xFF, "??? ?????"} };
 
 // Contains all of the internals relevant to the CPU.
-struct CPUInternals {
-	Registers registers;
-
-	bool interruptRequested;  // Whether a REQUEST for an interrupt has been made.
-	bool performInterrupt;  // Whether to PERFORM an interrupt in the current cpu cycle.
-
-	bool nmiRequested;  // Whether a REQUEST for an NMI has been made.
-	bool lastNMISignal;  // The last NMI signal; so if the PPU is on Vblank, this gets set to true. This also prevents another NMI from being requested (assuming the PPU's Vblank status is still true).
-	bool performNMI;  // Whether to PERFORM an NMI in the current CPU cycle. 
-
-	bool getOrPutCycle;  // Bool indicating whether the current cycle is a get (false) or a put (true) cycle. Starts as a get cycle, alternates back and forth every cycle. 
-	unsigned long long totalCyclesElapsed;  // Total CPU cycles elapsed since startup. NOTE: Buggy because it does not count DMA cycles.
-	unsigned int opcodeCyclesElapsed;  // A cycle counter that is present since the CPU began executing a given instruction. Resets when it reaches the number of cycles for a given instruction.
-	unsigned int currentOpcodeCycleLen;  // The number of cycles the current opcode uses.
-
+struct CPUInternals : public CPUState {
 	CPUInternals();
 	~CPUInternals();
 
-	// Gets the serialized format of the above data (as a string).
+	// Gets the serialized format of the CPU's state (as a string).
 	std::string getSerialFormat() const;
 	// Taking in a string (which usually has just been deserialized), it sets its member values to the corresponding values in the string.
 	void deserializeData(std::stringstream& data);
@@ -1,6 +1,7 @@
 #include "NESDebug.h"
 #include "CPUAnalyzer.h"
-#include <minmax.h>
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <filesystem>
 
@@ -11,6 +12,7 @@ NESDebug::NESDebug() : NES() {
 	NES::attachPPU(&this->debugPPU);
 	NES::attachRAM(&this->debugRAM);
 	NES::attachVRAM(&this->debugVRAM);
+	NES::setFastOAMDMA(false);  // So OAM DMA can be stepped through a byte at a time.
 }
 /*
 NESDebug::NESDebug(NESDatabus* databus, _6502_CPU* CPU, RAM* ram, Memory* vram, PPU* ppu) 
@@ -132,7 +134,7 @@ void NESDebug::getRAM(RAM& ram) {
 	ram = this->debugRAM;
 }
 
-void NESDebug::getVRAM(Memory& vram) {
+void NESDebug::getVRAM(VideoRAM& vram) {
 	vram = this->debugVRAM;
 }
 
@@ -270,7 +272,7 @@ void displayMemDump(std::vector<uint8_t>& dump, uint16_t startAddr, uint16_t end
 
 void displayMemDumpLine(std::vector<uint8_t>& dump, uint16_t startAddr, uint16_t endAddr, unsigned int row, unsigned int bytesPerRow) {
 	std::cout << displayHex(startAddr + row * bytesPerRow, 4) << " | ";
-	unsigned int rowSize = min((endAddr - startAddr) - row * bytesPerRow, bytesPerRow);  // This gives you how many bytes are left to display in total (not just for this row).
+	unsigned int rowSize = std::min<unsigned int>((endAddr - startAddr) - row * bytesPerRow, bytesPerRow);  // This gives you how many bytes are left to display in total (not just for this row).
 
 	for (unsigned int i = 0; i <= rowSize; ++i) {
 		std::cout << displayHex(dump.at(i + row * bytesPerRow), 2) << ' ';
@@ -11,6 +11,7 @@
 #include <set>
 #include <iostream>
 #include <algorithm>
+#include <filesystem>
 
 inline uint32_t memAddrToiNESAddr(uint16_t memAddr) {
 	return (memAddr - 0x8000 + 0x10) % 0x4000;
@@ -79,13 +80,13 @@ public:
 	CPUInternals getCPUInternals() const;
 	OAMDMAUnit getOAMDMAUnit() const;  // Returns a reference to the OAM DMA unit inside the NES.
 	void getRAM(RAM& RAM);  // Copies the current values inside RAM to the memory indicated by the argument.
-	void getVRAM(Memory& VRAM);  // Like getRAM but gets VRAM instead. NOTE: Might be removed.
+	void getVRAM(VideoRAM& VRAM);  // Like getRAM but gets VRAM instead. NOTE: Might be removed.
 
 	// Instances of the debugger versions of the databus and CPU.
 	PPUDebug debugPPU;
 	CPUDebugger debugCPU;
 	NESDatabus debugDatabus;
-	Memory debugVRAM{ VRAM_SIZE };
+	VideoRAM debugVRAM;
 	RAM debugRAM;
 	Memory debugMemory{ 0x10000 };
 
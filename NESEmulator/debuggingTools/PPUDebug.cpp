@@ -8,7 +8,7 @@
 PPUDebug::PPUDebug() : PPU() {
 }
 
-PPUDebug::PPUDebug(Memory* VRAM, Memory* CHRDATA) : PPU(VRAM, CHRDATA) {
+PPUDebug::PPUDebug(VideoRAM* VRAM, Memory* CHRDATA) : PPU(VRAM, CHRDATA) {
 }
 
 PPUDebug::~PPUDebug()
@@ -17,56 +17,14 @@ PPUDebug::~PPUDebug()
 
 PPUInternals PPUDebug::getInternals() const {
 	PPUInternals ppuInternals;
-	ppuInternals.backgroundShiftRegisters = this->backgroundShiftRegisters;
-	ppuInternals.latches = this->latches;
-	ppuInternals.spriteShiftRegisters = this->spriteShiftRegisters;
-	ppuInternals.x = this->x;
-	ppuInternals.t = this->t;
-	ppuInternals.v = this->v;
-	ppuInternals.w = this->w;
-	ppuInternals.control = this->control;
-	ppuInternals.mask = this->mask;
-	ppuInternals.status = this->status;
-	ppuInternals.beamPos = this->beamPos;
-	ppuInternals.cycleCount = this->cycleCount;
-	ppuInternals.frameCount = this->frameCount;
-	ppuInternals.paletteControl = this->paletteControl;
-	ppuInternals.OAM = this->OAM;
-	ppuInternals.secondaryOAM = this->secondaryOAM;
-	ppuInternals.spriteEvalCycle = this->spriteEvalCycle;
-	ppuInternals.requestingOAMDMA = this->requestingOAMDMA;
-	ppuInternals.dmaPage = this->dmaPage;
-	ppuInternals.OAMAddr = this->OAMAddr;
-	ppuInternals.PPUDATABuffer = this->PPUDATABuffer;
-	ppuInternals.ioBus = this->ioBus;
+	static_cast<PPUState&>(ppuInternals) = this->getState();
 	ppuInternals.VRAM = (*this->VRAM);
 
 	return ppuInternals;
 }
 
 bool PPUDebug::loadInternals(PPUInternals ppuInternals) {
-	this->backgroundShiftRegisters = ppuInternals.backgroundShiftRegisters;
-	this->latches = ppuInternals.latches;
-	this->spriteShiftRegisters = ppuInternals.spriteShiftRegisters;
-	this->x = ppuInternals.x;
-	this->t = ppuInternals.t;
-	this->v = ppuInternals.v;
-	this->w = ppuInternals.w;
-	this->control = ppuInternals.control;
-	this->mask = ppuInternals.mask;
-	this->status = ppuInternals.status;
-	this->beamPos = ppuInternals.beamPos;
-	this->cycleCount = ppuInternals.cycleCount;
-	this->frameCount = ppuInternals.frameCount;
-	this->paletteControl = ppuInternals.paletteControl;
-	this->OAM = ppuInternals.OAM;
-	this->secondaryOAM = ppuInternals.secondaryOAM;
-	this->spriteEvalCycle = ppuInternals.spriteEvalCycle;
-	this->requestingOAMDMA = ppuInternals.requestingOAMDMA;
-	this->dmaPage = ppuInternals.dmaPage;
-	this->OAMAddr = ppuInternals.OAMAddr;
-	this->PPUDATABuffer = ppuInternals.PPUDATABuffer;
-	this->ioBus = ppuInternals.ioBus;
+	this->loadState(ppuInternals);
 	*this->VRAM = ppuInternals.VRAM;
 
 	return true;
@@ -276,7 +234,7 @@ void PPUDebug::displaySprite(SpriteData spriteData, int x, int y) {
 SpriteData::SpriteData() : x(0xff), y(0xff), pattern(0xff), attribute(0xff) {}
 SpriteData::~SpriteData() {}
 
-PPUInternals::PPUInternals() : VRAM(VRAM_SIZE) {}
+PPUInternals::PPUInternals() {}
 
 PPUInternals::~PPUInternals() {}
 
@@ -1,17 +1,21 @@
 #include "frameCounter.h"
-#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
 
 FrameCounter::FrameCounter() : frame_lookback(60) {}
 FrameCounter::FrameCounter(const unsigned int frame_lookback) : frame_lookback(frame_lookback) {
 	if (frame_lookback > MAX_FRAME_LOOKBACK_ALLOWED) {
-		throw std::exception("frame_lookback given is too big; max size of 1000 is allowed.");
+		throw std::invalid_argument("frame_lookback given is too big; max size of 1000 is allowed.");
 	}
 }
 FrameCounter::~FrameCounter() {}
 
 double FrameCounter::getFrameRate() const {
 	if (this->recorded_times.size() == 0) return 0;
-	return (1000.0 / this->getMSPerFrame().count());
+	// Done in seconds rather than w/ getMSPerFrame since whole milliseconds are too coarse (e.g. 16ms would be 62.5 fps).
+	std::chrono::duration<double> avg_time_elapsed = (std::chrono::steady_clock::now() - this->recorded_times.front()) / this->recorded_times.size();
+	return 1.0 / avg_time_elapsed.count();
 }
 
 std::chrono::milliseconds FrameCounter::getMSPerFrame() const {
@@ -25,10 +29,26 @@ std::chrono::milliseconds FrameCounter::getMSPerFrame() const {
 	return std::chrono::duration_cast<std::chrono::milliseconds>(avg_time_elapsed);
 }
 
+double FrameCounter::getFrameTimePercentile(double percentile) const {
+	if (this->recorded_times.size() < 2) return 0;
+
+	std::vector<double> frame_times;
+	frame_times.reserve(this->recorded_times.size() - 1);
+	for (size_t i = 1; i < this->recorded_times.size(); ++i) {
+		frame_times.push_back(std::chrono::duration<double, std::milli>(this->recorded_times[i] - this->recorded_times[i - 1]).count());
+	}
+
+	// Nearest-rank percentile.
+	percentile = std::clamp(percentile, 0.0, 100.0);
+	size_t rank = static_cast<size_t>(percentile / 100.0 * (frame_times.size() - 1) + 0.5);
+	std::nth_element(frame_times.begin(), frame_times.begin() + rank, frame_times.end());
+	return frame_times[rank];
+}
+
 void FrameCounter::countFrame() {
 	if (this->recorded_times.size() >= this->frame_lookback) {
-		this->recorded_times.pop();  // Remove the first element added.
+		this->recorded_times.pop_front();  // Remove the first element added.
 	}
 	// Record the current time.
-	this->recorded_times.push(std::chrono::steady_clock::now());
+	this->recorded_times.push_back(std::chrono::steady_clock::now());
 }
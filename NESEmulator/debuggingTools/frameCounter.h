@@ -2,7 +2,7 @@
 #pragma once
 
 #include <chrono>
-#include <queue>
+#include <deque>
 
 constexpr unsigned int MAX_FRAME_LOOKBACK_ALLOWED = 1000;  // This is to prevent the vector of times_recorded from growing obscenely big.
 
@@ -19,8 +19,12 @@ public:
 	
 	std::chrono::milliseconds getMSPerFrame() const;  // Gets how many milliseconds on average (of the last frame_lookback frames) each frame lasts.
 
+	// Gets the time between frames (of the last frame_lookback frames) which the given percentage of frames were at least as fast as, in 
+	// milliseconds; e.g. 50 gives the median and 99 gives the time only the slowest 1% of frames took longer than. 0 if fewer than 2 frames were counted.
+	double getFrameTimePercentile(double percentile) const;
+
 	void countFrame();  // Counts the current frame.	
 private:
 	const int frame_lookback;  // How many frames should be measured to determine the fps (also the number of frames ago the last time measurement was made).
-	std::queue<std::chrono::time_point<std::chrono::steady_clock>> recorded_times;  // The times recorded at each frame; is equal in length to frame_look back.
+	std::deque<std::chrono::time_point<std::chrono::steady_clock>> recorded_times;  // The times recorded at each frame; is equal in length to frame_look back.
 };
\ No newline at end of file
@@ -2,14 +2,15 @@
 
 #include "../../input/cmdInput.h"
 #include "../../debuggingTools/PPUDebug.h"
-#include "../../debuggingTools/nesDebug.h"
+#include "../../debuggingTools/NESDebug.h"
 #include "../../debuggingTools/CPUAnalyzer.h"
 #include "../../graphics/graphics.h"
+#include "../../graphics/sdlDisplay.h"
 #include "../../debuggingTools/debugDisplays/tableDisplayer.h"
 #include "../../debuggingTools/debugDisplays/paletteDisplayer.h"
 
 #include <SDL.h>
-#include <minmax.h>
+#include <algorithm>
 #include <set>
 #include <fstream>
 #include <filesystem>
@@ -75,6 +76,8 @@ GeneralDebugSuite::GeneralDebugSuite() :
 		{'s', {'s', "Save NES internals (includes RAM, VRAM, and DMA data)"}},
 		{'t', {'t', "Print available save states (prints the machine cycle associated w/ it)"}},
 		{'u', {'u', "Delete a given save state"}},
+		{'w', {'w', "Write a save state to the save state directory (optionally w/ a human-readable .txt copy)"}},
+		{'W', {'W', "Load the save states in the save state directory"}},
 		{'x', {'x', "Clears the screen"}},
 		{'r', {'r', "Peek and or poke RAM"}},
 		{'R', {'R', "Peek and or poke the Tilemap."}},
@@ -98,6 +101,8 @@ GeneralDebugSuite::GeneralDebugSuite() :
 		{'t', true},
 		{'u', true},
 		{'v', true},
+		{'w', true},
+		{'W', true},
 		{'x', true},
 		{'r', true},
 		{'g', true},
@@ -228,14 +233,27 @@ void GeneralDebugSuite::run() {
 			this->loadState(idxToLoad);
 			break;
 		}
+		case('w'): {
+			if (!std::filesystem::is_directory(this->saveStateDir)) {
+				this->setSaveStateDir();
+			}
+			int idxToSerialize = this->CLIInputHandler.getUserInt("What index to write?\n");
+			this->serializeState(idxToSerialize);
+			if (this->CLIInputHandler.getUserChar(" * Also export it as text (y/n)? ") == 'y') {
+				this->exportState(idxToSerialize);
+			}
+			break;
+		}
+		case('W'): {
+			if (!std::filesystem::is_directory(this->saveStateDir)) {
+				this->setSaveStateDir();
+			}
+			this->loadSerializedStates();
+			break;
+		}
 		case('x'): {
-			
 			this->clearDisplay();
 			this->updateDisplay();
-
-			// Old function of 'x'
-			//int idxToSerialize = this->CLIInputHandler.getUserInt("What index to serialize?\n");
-			//this->serializeState(idxToSerialize);
 			break;
 		}
 		case('g'): {
@@ -405,7 +423,7 @@ void GeneralDebugSuite::updateDisplay() {
 	displayPalette(this->graphics, this->nes.debugPPU, 341, 0, 3);
 
 
-	this->graphics.blitDisplay(this->windowSurface);
+	blitDisplay(this->graphics, this->windowSurface);
 	SDL_UpdateWindowSurface(this->window);
 }
 
@@ -537,7 +555,7 @@ double GeneralDebugSuite::measureFPS(const int num_frames) {
 	// We save the internals of the CPU, PPU, RAM, and VRAM.
 	this->nes.getNESInternals(internals);
 	this->saveStates.push_back(internals);
-	int actual_num_frames = min(num_frames, MAX_FRAME_LOOKBACK_ALLOWED);  // Cap the number of frames to measure by MAX_...
+	int actual_num_frames = std::min<int>(num_frames, MAX_FRAME_LOOKBACK_ALLOWED);  // Cap the number of frames to measure by MAX_...
 	FrameCounter frame_counter(actual_num_frames);
 	for (int i = 0; i < actual_num_frames; ++i) {
 		frame_counter.countFrame();
@@ -699,9 +717,34 @@ void GeneralDebugSuite::serializeState(int idx) {
 	}
 
 	NESInternals internals = this->saveStates.at(idx - 1);
+	std::string filename = this->saveStateDir + internals.name + ".nesstate";
 
-	// Checking if there is a dot in the path, suggesting the user accidentally input a file.
-	std::string filename = internals.name + ".nesstate";
+	// The binary format is written by the NES itself, so the saved internals are swapped in for the duration of the write.
+	NESState currentState;
+	this->nes.getState(currentState);
+	this->nes.loadInternals(internals);
+	SaveStateResult::SaveStateResult result = this->nes.saveStateToFile(filename.c_str());
+	this->nes.loadState(currentState);
+
+	if (result != SaveStateResult::SUCCESS) {
+		std::cout << " * Unable to write " << filename << " (Error: " << result << ")\n";
+	}
+}
+
+void GeneralDebugSuite::exportState(int idx) {
+	if (idx > this->saveStates.size() || idx < 1) {
+		std::cout << "    * Invalid index " << std::dec << idx << " for save state vector of size " << this->saveStates.size() << std::endl;
+		return;
+	}
+	if (!std::filesystem::is_directory(this->saveStateDir)) {
+		std::cout << " * Please input a valid save state directory first.\n";
+		return;
+	}
+
+	NESInternals internals = this->saveStates.at(idx - 1);
+
+	// NOTE: This is the old human-readable text format; it is only meant for reading and diffing, use serializeState to make actual savestates.
+	std::string filename = internals.name + ".nesstate.txt";
 	filename = this->saveStateDir + filename;
 	std::ofstream file{ filename };
 	
@@ -719,26 +762,38 @@ void GeneralDebugSuite::loadSerializedStates() {
 	// First we list all the .nesstate files.
 	for (const auto& file : std::filesystem::directory_iterator(this->saveStateDir)) {
 		// Check if we are dealing w/ a .nesstate file. If not, skip it.
-		std::filesystem::path filepath = file.path().filename();
-		std::string filename = filepath.string();
-		if (filename.find(".nesstate") == std::string::npos) {
+		std::filesystem::path filepath = file.path();
+		if (filepath.extension() != ".nesstate") {
 			continue;
 		}
-		std::cout << filename << std::endl;
+		std::cout << filepath.filename().string() << std::endl;
 	}
 
 	char continueLoading = this->CLIInputHandler.getUserChar(" * Load files (y/n)? (They will be appended to the current vector of save states): ");
 	if (continueLoading == 'y') {
+		// Like serializeState, each file is loaded into the NES to read it, so the current state is restored afterwards.
+		NESState currentState;
+		this->nes.getState(currentState);
+
 		for (const auto& file : std::filesystem::directory_iterator(this->saveStateDir)) {
 			// Check if we are dealing w/ a .nesstate file. If not, skip it.
 			std::filesystem::path filepath = file.path();
-			std::string filename = filepath.filename().string();
-			if (filename.find(".nesstate") == std::string::npos) {
+			if (filepath.extension() != ".nesstate") {
 				continue;
 			}
 
-			NESInternals internals{ filepath };
+			SaveStateResult::SaveStateResult result = this->nes.loadStateFromFile(filepath.string().c_str());
+			if (result != SaveStateResult::SUCCESS) {
+				std::cout << " * Unable to load " << filepath.filename().string() << " (Error: " << result << ")\n";
+				continue;
+			}
+
+			NESInternals internals{ filepath.stem().string() };
+			this->nes.getNESInternals(internals);
+			this->saveStates.push_back(internals);
 		}
+
+		this->nes.loadState(currentState);
 	}
 }
 
@@ -6,6 +6,8 @@
 #include "../../ppu/ppu.h"
 #include "../frameCounter.h"
 
+#include <SDL.h>
+
 struct InputOptions {
 	char input;
 	std::string description;
@@ -88,9 +90,11 @@ private:
 	void saveState();
 	// Loads a saveState with the given index. If -1 is input, it loads the last saved saveState.
 	void loadState(int idx);
-	// Serializes a save state. See implementation for more details
+	// Writes a save state to the save state directory as a binary savestate (see savestates/saveState.h).
 	void serializeState(int idx);
-	// Loads in save states into the saveStates vector. (WIP)
+	// Exports a save state to the save state directory in the human-readable text format; this can not be loaded back in.
+	void exportState(int idx);
+	// Loads the binary save states in the save state directory into the saveStates vector.
 	void loadSerializedStates();
 	// Sets the directory of the save states.
 	void setSaveStateDir();
@@ -2,6 +2,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <algorithm>
 #define ASSERT_PARAMETERS
 #ifdef ASSERT_PARAMETERS
 #include <iostream>
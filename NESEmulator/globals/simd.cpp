@@ -0,0 +1,29 @@
+#include "simd.h"
+
+#if defined(NES_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+	bool detectAVX2() {
+#if !defined(NES_X86_SIMD)
+		return false;
+#elif defined(__GNUC__) || defined(__clang__)
+		return __builtin_cpu_supports("avx2");
+#else
+		int info[4];
+		__cpuid(info, 1);
+		bool osSavesYMM = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;  // OSXSAVE, then whether the OS saves the AVX registers.
+		if (!osSavesYMM) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return info[1] & (1 << 5);
+#endif
+	}
+}
+
+bool cpuSupportsAVX2() {
+	static const bool supported = detectAVX2();
+	return supported;
+}
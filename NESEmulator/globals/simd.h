@@ -0,0 +1,23 @@
+// simd.h - What x86 vector instructions can be used, for the few places which have hand-vectorized code paths.
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NES_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// SSE2 is part of x86-64, so only 32 bit builds may lack it.
+#if defined(NES_X86_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NES_SSE2 1
+#endif
+
+// GCC and Clang need to be told to emit AVX2 for the functions which use it; MSVC allows the intrinsics anywhere. Functions marked
+// w/ this must only be called after checking cpuSupportsAVX2.
+#if defined(__GNUC__) || defined(__clang__)
+#define NES_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NES_TARGET_AVX2
+#endif
+
+// Whether the CPU (and OS) can run AVX2 code; always false on non-x86 CPUs. Checked once, then cached.
+bool cpuSupportsAVX2();
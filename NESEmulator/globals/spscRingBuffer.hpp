@@ -0,0 +1,77 @@
+// spscRingBuffer.hpp - A fixed size queue of values (e.g. audio samples) from one thread to another which never blocks either thread.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+The writer only ever moves writeIndex and the reader only ever moves readIndex, so each side needs one atomic load of the other's
+index and one atomic store of its own per call, however many values it moves. The indices count up forever (a size_t will not wrap
+in practice) and are masked into the buffer, whose size is rounded up to a power of 2; the number of values queued is just their
+difference. Each index sits on its own cache line so the two threads do not keep taking the line from each other.
+
+Exactly one thread may write and exactly one thread may read. Values are copied, so T should be trivially copyable.
+*/
+template <typename T>
+class SPSCRingBuffer {
+public:
+	SPSCRingBuffer(size_t capacity) : buffer(roundUpToPowerOf2(std::max<size_t>(capacity, 1))), mask(buffer.size() - 1), writeIndex(0), readIndex(0) {}
+	~SPSCRingBuffer() {}
+
+	size_t getCapacity() const {
+		return this->buffer.size();
+	}
+	// Either side may call this; the other may change it at any moment, so it is only a snapshot.
+	size_t getSize() const {
+		return this->writeIndex.load(std::memory_order_acquire) - this->readIndex.load(std::memory_order_acquire);
+	}
+
+	// --- Writer --- //
+
+	// Queues as many of the values as fit and returns how many that was.
+	size_t write(const T* values, size_t count) {
+		size_t write = this->writeIndex.load(std::memory_order_relaxed);
+		size_t read = this->readIndex.load(std::memory_order_acquire);  // Whatever the reader has read before this is free to overwrite.
+		count = std::min(count, this->buffer.size() - (write - read));
+
+		size_t start = write & this->mask;
+		size_t firstPart = std::min(count, this->buffer.size() - start);  // The values up to the end of the buffer; the rest wrap around.
+		std::copy(values, values + firstPart, this->buffer.begin() + start);
+		std::copy(values + firstPart, values + count, this->buffer.begin());
+		this->writeIndex.store(write + count, std::memory_order_release);  // Publishes the values w/ the new index.
+		return count;
+	}
+
+	// --- Reader --- //
+
+	// Takes up to count values and returns how many were taken.
+	size_t read(T* values, size_t count) {
+		size_t read = this->readIndex.load(std::memory_order_relaxed);
+		size_t write = this->writeIndex.load(std::memory_order_acquire);
+		count = std::min(count, write - read);
+
+		size_t start = read & this->mask;
+		size_t firstPart = std::min(count, this->buffer.size() - start);
+		std::copy(this->buffer.begin() + start, this->buffer.begin() + start + firstPart, values);
+		std::copy(this->buffer.begin(), this->buffer.begin() + (count - firstPart), values + firstPart);
+		this->readIndex.store(read + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	static size_t roundUpToPowerOf2(size_t value) {
+		size_t power = 1;
+		while (power < value) {
+			power <<= 1;
+		}
+		return power;
+	}
+
+	std::vector<T> buffer;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> writeIndex;
+	alignas(64) std::atomic<size_t> readIndex;
+};
@@ -0,0 +1,63 @@
+// tripleBuffer.hpp - Hands values (e.g. frames) from one thread to another w/o either thread ever waiting on the other.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+Three slots: the writer owns one (the back), the reader owns one (the front), and the third (the middle) holds the newest value
+which has been published but not taken yet. Publishing swaps the back w/ the middle and taking swaps the front w/ the middle; each
+is a single atomic exchange, so neither thread blocks and neither can see a slot while the other is using it (i.e. no tearing).
+If the writer publishes faster than the reader takes, the unread value is overwritten, so the reader always gets the newest one.
+
+Exactly one thread may write and exactly one thread may read.
+*/
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() : slots(), back(0), front(2), published(1), state(1) {}
+	~TripleBuffer() {}
+
+	// --- Writer --- //
+
+	// The slot to fill in before calling publish.
+	T& getWriteBuffer() {
+		return this->slots[this->back];
+	}
+	// Makes the write buffer the newest value and gives the writer a different slot to fill in. The new write buffer holds an older
+	// value (whatever the reader or the previous publish left in it); copy getPublished into it if the next value builds on the last.
+	void publish() {
+		this->published = this->back;
+		uint8_t old = this->state.exchange(this->back | FRESH, std::memory_order_acq_rel);
+		this->back = old & INDEX_MASK;
+	}
+	// The value last published. The reader may be reading it at the same time, so it must only be read.
+	const T& getPublished() const {
+		return this->slots[this->published];
+	}
+
+	// --- Reader --- //
+
+	// Takes the newest published value if the reader has not taken it yet; returns whether the read buffer changed.
+	bool update() {
+		if (!(this->state.load(std::memory_order_relaxed) & FRESH)) {
+			return false;
+		}
+		uint8_t old = this->state.exchange(this->front, std::memory_order_acq_rel);
+		this->front = old & INDEX_MASK;
+		return true;
+	}
+	const T& getReadBuffer() const {
+		return this->slots[this->front];
+	}
+
+private:
+	static constexpr uint8_t INDEX_MASK = 0b011;
+	static constexpr uint8_t FRESH = 0b100;  // Set when the middle slot holds a value the reader has not taken.
+
+	std::array<T, 3> slots;
+	uint8_t back, front;  // Only used by the writer and the reader respectively.
+	uint8_t published;  // Writer only.
+	std::atomic<uint8_t> state;  // The index of the middle slot and the FRESH bit.
+};
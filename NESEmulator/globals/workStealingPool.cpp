@@ -0,0 +1,117 @@
+#include "workStealingPool.h"
+
+#include <algorithm>
+
+namespace {
+	// Which pool and worker the current thread is, so tasks which submit more work put it on their own worker's queue.
+	thread_local const WorkStealingPool* currentPool = nullptr;
+	thread_local unsigned int currentWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int numThreads) : nextWorker(0), queued(0), unfinished(0), stopping(false), steals(0) {
+	numThreads = std::max(numThreads, 1u);
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		this->workers.push_back(std::make_unique<Worker>());
+	}
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		this->threads.emplace_back(&WorkStealingPool::run, this, i);
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	this->wait();
+	{
+		std::lock_guard<std::mutex> lock{ this->mutex };
+		this->stopping = true;
+	}
+	this->taskQueued.notify_all();
+	for (std::thread& thread : this->threads) {
+		thread.join();
+	}
+}
+
+void WorkStealingPool::submit(Task task) {
+	unsigned int index = currentPool == this ? currentWorker : this->nextWorker.fetch_add(1, std::memory_order_relaxed) % this->workers.size();
+	{
+		std::lock_guard<std::mutex> lock{ this->workers[index]->mutex };
+		this->workers[index]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock{ this->mutex };
+		++this->queued;
+		++this->unfinished;
+	}
+	this->taskQueued.notify_one();
+}
+
+void WorkStealingPool::wait() {
+	std::unique_lock<std::mutex> lock{ this->mutex };
+	this->allFinished.wait(lock, [this]() { return this->unfinished == 0; });
+}
+
+unsigned int WorkStealingPool::getThreadCount() const {
+	return static_cast<unsigned int>(this->threads.size());
+}
+
+unsigned long long WorkStealingPool::getSteals() const {
+	return this->steals.load(std::memory_order_relaxed);
+}
+
+void WorkStealingPool::run(unsigned int index) {
+	currentPool = this;
+	currentWorker = index;
+
+	while (true) {
+		{
+			// A task is only taken once queued says one is waiting, so a worker never spins through the queues for nothing.
+			std::unique_lock<std::mutex> lock{ this->mutex };
+			this->taskQueued.wait(lock, [this]() { return this->stopping || this->queued > 0; });
+			if (this->queued == 0) {
+				return;  // Stopping and nothing is left.
+			}
+			--this->queued;
+		}
+
+		// Tasks are pushed before they are counted and each worker takes one task per count, so there is always one to take, but a 
+		// scan can still miss it (e.g. the task it would have found is stolen while a new one lands in a queue already looked at). 
+		// So scan until one is found; the task is never more than one more scan away.
+		Task task;
+		while (!this->takeTask(index, task)) {
+			std::this_thread::yield();
+		}
+		task();
+
+		bool finished;
+		{
+			std::lock_guard<std::mutex> lock{ this->mutex };
+			finished = --this->unfinished == 0;
+		}
+		if (finished) {
+			this->allFinished.notify_all();
+		}
+	}
+}
+
+bool WorkStealingPool::takeTask(unsigned int index, Task& task) {
+	{
+		Worker& own = *this->workers[index];
+		std::lock_guard<std::mutex> lock{ own.mutex };
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < this->workers.size(); ++i) {
+		Worker& victim = *this->workers[(index + i) % this->workers.size()];
+		std::lock_guard<std::mutex> lock{ victim.mutex };
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			this->steals.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
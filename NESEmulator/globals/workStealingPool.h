@@ -0,0 +1,57 @@
+// workStealingPool.h - Runs tasks on a fixed set of threads, each w/ its own queue, which steal from each other when they run out.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Each worker has its own queue. submit spreads tasks over the queues in turn (or puts them on the calling worker's own queue when a
+task submits more work), and a worker takes from the back of its own queue but steals from the front of the others' once its own
+is empty. So workers mostly touch only their own queue, and when tasks take very different amounts of time (e.g. emulating a
+few seconds of one game and an hour of another) no worker sits idle while another still has a backlog.
+
+The queues are short and each task is expected to run for a while, so each queue is guarded by a plain mutex rather than being
+lock-free. Idle workers sleep until a task is submitted.
+*/
+class WorkStealingPool {
+public:
+	using Task = std::function<void()>;
+
+	WorkStealingPool(unsigned int numThreads = std::thread::hardware_concurrency());  // 0 is treated as 1.
+	~WorkStealingPool();  // Runs every task still queued, then joins the workers.
+
+	// May be called from any thread, including by a task.
+	void submit(Task task);
+	// Waits until every task submitted so far has finished. Must not be called by a task.
+	void wait();
+
+	unsigned int getThreadCount() const;
+	unsigned long long getSteals() const;  // How many tasks were run by a worker other than the one they were queued on.
+
+private:
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void run(unsigned int index);
+	bool takeTask(unsigned int index, Task& task);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+	std::atomic<unsigned int> nextWorker;  // The queue the next task from outside the pool goes on.
+
+	std::mutex mutex;  // Guards queued, unfinished and stopping.
+	std::condition_variable taskQueued, allFinished;
+	size_t queued;  // Tasks waiting in any queue.
+	size_t unfinished;  // Tasks queued or running.
+	bool stopping;
+
+	std::atomic<unsigned long long> steals;
+};
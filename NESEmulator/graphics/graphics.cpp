@@ -1,45 +1,33 @@
 #include "graphics.h"
 
 #include <iostream>
-#include <minmax.h>
-#include <SDL.h>
 
-Graphics::Graphics() : pxIdx(0), w(PICTURE_REGION_WIDTH), h(PICTURE_REGION_HEIGHT), totalPx(w*h), displayBounds(DISPLAY_BOUNDS) {
-	this->display = SDL_CreateRGBSurfaceWithFormat(NULL, w, h, 8, SDL_PIXELFORMAT_RGBA8888);  // NOTE: For some reason, I am forced to use 32 bits to define color. Need to figure out how to make it use 8 bits (if it becomes a problem).
-	this->pixels = (uint32_t*)this->display->pixels;
-}
+Graphics::Graphics() : pxIdx(0), w(PICTURE_REGION_WIDTH), h(PICTURE_REGION_HEIGHT), totalPx(w*h), pixels(totalPx, 0), displayBounds(DISPLAY_BOUNDS) {}
 
-Graphics::Graphics(unsigned int w, unsigned int h) : pxIdx(0), w(w), h(h), totalPx(w* h) {
-	this->displayBounds = SDL_Rect(0, 0, w, h);
-	this->display = SDL_CreateRGBSurfaceWithFormat(NULL, w, h, 8, SDL_PIXELFORMAT_RGBA8888);
-	this->pixels = (uint32_t*)this->display->pixels;
+Graphics::Graphics(unsigned int w, unsigned int h) : pxIdx(0), w(w), h(h), totalPx(w* h), pixels(totalPx, 0) {
+	this->displayBounds = Rect{ 0, 0, static_cast<int>(w), static_cast<int>(h) };
 }
 
-Graphics::Graphics(unsigned int w, unsigned int h, SDL_Rect displayBounds) : pxIdx(0), w(w), h(h), totalPx(w*h), displayBounds(displayBounds) {
+Graphics::Graphics(unsigned int w, unsigned int h, Rect displayBounds) : pxIdx(0), w(w), h(h), totalPx(w*h), pixels(totalPx, 0), displayBounds(displayBounds) {
 	// Check if the given bounds are valid; if not, default to
 	if (!this->isBoundsValid(displayBounds)) {
 		std::cout << "Warning, bounds given for a Graphics object are invalid; defaulting to full bounds (w: " << this->w << ", h: " << this->h << ")";
-		this->displayBounds = SDL_Rect(0, 0, w, h);
+		this->displayBounds = Rect{ 0, 0, static_cast<int>(w), static_cast<int>(h) };
 	}
-	this->display = SDL_CreateRGBSurfaceWithFormat(NULL, w, h, 8, SDL_PIXELFORMAT_RGBA8888);
-	this->pixels = (uint32_t*)this->display->pixels;
 }
 
-Graphics::~Graphics() {
-	SDL_FreeSurface(this->display);
-}
+Graphics::~Graphics() {}
 
-void Graphics::lockDisplay() {
-	SDL_LockSurface(this->display);
+const uint32_t* Graphics::getPixels() const {
+	return this->pixels.data();
 }
 
-void Graphics::unlockDisplay() {
-	SDL_UnlockSurface(this->display);
+uint32_t* Graphics::getPixels() {
+	return this->pixels.data();
 }
 
-
-void Graphics::blitDisplay(SDL_Surface* windowSurface) {
-	SDL_BlitScaled(this->display, &this->displayBounds, windowSurface, nullptr);
+Rect Graphics::getDisplayBounds() const {
+	return this->displayBounds;
 }
 
 void Graphics::clear(uint32_t rgb) {
@@ -83,15 +71,11 @@ void Graphics::setPxIdx(int newPxIdx) {
 
 // Private methods
 
-const SDL_PixelFormat* Graphics::getDisplayFormat() const {
-	return this->display->format;
-}
-
 uint32_t Graphics::getRGB(uint8_t r, uint8_t g, uint8_t b) const {
-	return SDL_MapRGB(this->display->format, r, g, b);;
+	return (r << 24) | (g << 16) | (b << 8) | 0xff;  // RGBA8888 w/ an opaque alpha.
 }
 
-bool Graphics::isBoundsValid(SDL_Rect displayBounds) const {
+bool Graphics::isBoundsValid(Rect displayBounds) const {
 	// Assumes w and h have been set (which they should have been in the constructor).
 
 	bool xWithinBounds = this->w >= displayBounds.x + displayBounds.w && displayBounds.x >= 0;
@@ -101,5 +85,5 @@ bool Graphics::isBoundsValid(SDL_Rect displayBounds) const {
 }
 
 void Graphics::updateBeamLocation() {
-	this->pxIdx = this->pxIdx >= this->totalPx ? 0 : this->pxIdx + 1;
+	this->pxIdx = this->pxIdx + 1 >= this->totalPx ? 0 : this->pxIdx + 1;
 }
@@ -1,36 +1,37 @@
 #pragma once
 
-#include <SDL.h>
+#include <cstdint>
+#include <vector>
+
+// A rectangle of pixels; laid out the same as SDL_Rect so frontends can convert between the two trivially.
+struct Rect {
+	int x, y, w, h;
+};
 
 // Constants specificially referring to the NES's display parameters.
 constexpr unsigned int DISPLAY_WIDTH = 256, DISPLAY_HEIGHT = 240, PICTURE_REGION_WIDTH = 283, PICTURE_REGION_HEIGHT = 242;
-constexpr SDL_Rect DISPLAY_BOUNDS{16, 0, 256, 240};
+constexpr Rect DISPLAY_BOUNDS{16, 0, 256, 240};
 
-/* A class to display a mutable surface; the PPU will write to this surface(or use some intermediary) and this class will display it to the user.
+/* A mutable framebuffer; the PPU writes to it and a frontend displays it to the user (see graphics/sdlDisplay.h for the SDL one).
  This does NOT emulate NTSC video.
 
- NOTE: This implementation is very poor at streaming data; this is fine for now as it will just do debug views, but I want to change this when integrating everything together.
-
+ The pixels are kept in plain memory so the emulator core does not depend on any windowing or display library. Each pixel is
+ RGBA8888 (0xRRGGBBAA), which is the same format the palette is loaded in, and the pixels are stored row by row.
 */
 
 class Graphics {
 public:
 	Graphics();
 	Graphics(unsigned int w, unsigned int h);  // Sets the display bounds to cover the entire surface.
-	Graphics(unsigned int w, unsigned int h, SDL_Rect displayBounds);  // If the display bounds are invalid (e.g. a greater width than w), then it defaults to covering the entire surface.
+	Graphics(unsigned int w, unsigned int h, Rect displayBounds);  // If the display bounds are invalid (e.g. a greater width than w), then it defaults to covering the entire surface.
 	~Graphics();
 
-	// To be called before drawing.
-	void lockDisplay();
-
-	// To be called after drawing and before copying to the window surface.
-	void unlockDisplay();
-
-	// Copies the visual display to the window and updates it. NOTE: Might rename the function to make the updating-the-screen part more clear.
-	void blitDisplay(SDL_Surface* windowSurface);
+	// Gets the pixels of the surface (w * h of them, row by row).
+	const uint32_t* getPixels() const;
+	uint32_t* getPixels();
 
-	// Returns the display format of the display surface.
-	const SDL_PixelFormat* getDisplayFormat() const;
+	// Gets the rectangle of the surface which is meant to be displayed.
+	Rect getDisplayBounds() const;
 
 	uint32_t getRGB(uint8_t r, uint8_t g, uint8_t b) const;
 
@@ -54,15 +55,14 @@ public:
 
 private:
 
-	bool isBoundsValid(SDL_Rect displayBounds) const;  // Checks if a given displayBounds is sound (the rect does not go out of bounds of the display surface dimensions).
+	bool isBoundsValid(Rect displayBounds) const;  // Checks if a given displayBounds is sound (the rect does not go out of bounds of the display surface dimensions).
 
 	void updateBeamLocation();
 
 	// "The PPU outputs a picture region of 256x240 pixels and a border region extending 16 pixels left, 11 pixels right, and 2 pixels down (283x242)."
-	SDL_Surface* display;  // The 283x242 display.
-	uint32_t* pixels;  // Pointer to the pixels located in the display; defined to prevent casting the void pointer in the display surface to a uint32_t pointer when drawing pixels.
+	std::vector<uint32_t> pixels;  // The 283x242 display by default.
 
-	SDL_Rect displayBounds;  // The rectangle bounding the pixels which are actually displayed.
+	Rect displayBounds;  // The rectangle bounding the pixels which are actually displayed.
 
 	int pxIdx; // Location of the "scanning beam" 
 
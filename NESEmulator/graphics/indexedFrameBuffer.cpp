@@ -0,0 +1,157 @@
+#include "indexedFrameBuffer.h"
+
+#include "../globals/simd.h"
+
+#include <cstring>
+
+namespace {
+	constexpr uint16_t COLOR_KEY_MASK = PALETTE_LUT_SIZE - 1;
+
+	void convertColorKeysScalar(const uint16_t* keys, uint32_t* out, size_t count, const uint32_t* lut) {
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = lut[keys[i] & COLOR_KEY_MASK];
+		}
+	}
+
+#ifdef NES_X86_SIMD
+	// Converts 8 keys at a time: widen the 16 bit keys to 32 bits, then gather their colors from the table.
+	NES_TARGET_AVX2 void convertColorKeysAVX2(const uint16_t* keys, uint32_t* out, size_t count, const uint32_t* lut) {
+		const __m256i mask = _mm256_set1_epi32(COLOR_KEY_MASK);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i packedKeys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+			__m256i indices = _mm256_and_si256(_mm256_cvtepu16_epi32(packedKeys), mask);
+			__m256i colors = _mm256_i32gather_epi32(reinterpret_cast<const int*>(lut), indices, 4);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), colors);
+		}
+		convertColorKeysScalar(keys + i, out + i, count - i, lut);
+	}
+#endif
+
+	using ConvertFunction = void(*)(const uint16_t*, uint32_t*, size_t, const uint32_t*);
+
+	ConvertFunction chooseConvertFunction() {
+#ifdef NES_X86_SIMD
+		if (cpuSupportsAVX2()) {
+			return convertColorKeysAVX2;
+		}
+#endif
+		return convertColorKeysScalar;
+	}
+}
+
+PaletteLUT makePaletteLUT(const std::map<uint16_t, uint32_t>& paletteMap) {
+	PaletteLUT lut{};
+	for (uint16_t key = 0; key < PALETTE_LUT_SIZE; ++key) {
+		auto color = paletteMap.find(key);
+		if (color == paletteMap.end()) {
+			color = paletteMap.find(key & 0x3f);
+		}
+		lut[key] = color == paletteMap.end() ? 0x000000ff : color->second;
+	}
+	return lut;
+}
+
+void convertColorKeys(const uint16_t* keys, uint32_t* out, size_t count, const PaletteLUT& lut) {
+	static const ConvertFunction convert = chooseConvertFunction();
+	convert(keys, out, count, lut.data());
+}
+
+IndexedFrameBuffer::IndexedFrameBuffer() : lineHashes{}, dirtyLines{}, numDirtyLines(0) {
+	this->clear();
+}
+IndexedFrameBuffer::~IndexedFrameBuffer() {}
+
+uint16_t IndexedFrameBuffer::getPixel(unsigned int x, unsigned int y) const {
+	return this->pixels[x + y * DISPLAY_WIDTH];
+}
+
+const uint16_t* IndexedFrameBuffer::getPixels() const {
+	return this->pixels.data();
+}
+
+void IndexedFrameBuffer::clear(uint16_t colorKey) {
+	this->pixels.fill(colorKey);
+
+	this->beginFrame();
+	for (unsigned int y = 0; y < DISPLAY_HEIGHT; ++y) {
+		this->finishLine(y);
+	}
+}
+
+void IndexedFrameBuffer::beginFrame() {
+	this->dirtyLines.fill(false);
+	this->numDirtyLines = 0;
+}
+
+void IndexedFrameBuffer::finishLine(unsigned int y) {
+	uint64_t hash = this->hashLine(y);
+	if (hash != this->lineHashes[y] && !this->dirtyLines[y]) {
+		this->dirtyLines[y] = true;
+		++this->numDirtyLines;
+	}
+	this->lineHashes[y] = hash;
+}
+
+uint64_t IndexedFrameBuffer::getLineHash(unsigned int y) const {
+	return this->lineHashes[y];
+}
+
+uint64_t IndexedFrameBuffer::getFrameHash() const {
+	uint64_t hash = 0;
+	for (uint64_t lineHash : this->lineHashes) {
+		hash = hash * 0x100000001b3 + lineHash;
+	}
+	return hash;
+}
+
+bool IndexedFrameBuffer::isLineDirty(unsigned int y) const {
+	return this->dirtyLines[y];
+}
+
+unsigned int IndexedFrameBuffer::getNumDirtyLines() const {
+	return this->numDirtyLines;
+}
+
+bool IndexedFrameBuffer::isUnchanged() const {
+	return this->numDirtyLines == 0;
+}
+
+uint64_t IndexedFrameBuffer::hashLine(unsigned int y) const {
+	// FNV-1a over the line 4 pixels at a time.
+	const uint64_t FNV_OFFSET = 0xcbf29ce484222325, FNV_PRIME = 0x100000001b3;
+	const uint16_t* line = this->pixels.data() + y * DISPLAY_WIDTH;
+
+	uint64_t hash = FNV_OFFSET;
+	for (unsigned int x = 0; x < DISPLAY_WIDTH; x += 4) {
+		uint64_t chunk;
+		std::memcpy(&chunk, line + x, sizeof(chunk));
+		hash = (hash ^ chunk) * FNV_PRIME;
+	}
+	return hash;
+}
+
+void IndexedFrameBuffer::convertToRGBA(const PaletteLUT& lut, uint32_t* out, size_t pitch) const {
+	this->convertLinesToRGBA(lut, 0, DISPLAY_HEIGHT, out, pitch);
+}
+
+void IndexedFrameBuffer::convertLinesToRGBA(const PaletteLUT& lut, unsigned int firstLine, unsigned int numLines, uint32_t* out, size_t pitch) const {
+	const uint16_t* firstKey = this->pixels.data() + firstLine * DISPLAY_WIDTH;
+	if (pitch == DISPLAY_WIDTH) {  // The rows are contiguous, so all the lines can be done in one go.
+		convertColorKeys(firstKey, out, numLines * DISPLAY_WIDTH, lut);
+		return;
+	}
+
+	for (unsigned int y = 0; y < numLines; ++y) {
+		convertColorKeys(firstKey + y * DISPLAY_WIDTH, out + y * pitch, DISPLAY_WIDTH, lut);
+	}
+}
+
+void IndexedFrameBuffer::drawTo(Graphics& graphics, const PaletteLUT& lut, unsigned int x, unsigned int y) const {
+	// The surface's size is never negative (it is constructed from unsigned ints), so it can be compared as unsigned.
+	unsigned int width = static_cast<unsigned int>(graphics.w), height = static_cast<unsigned int>(graphics.h);
+	if (x + DISPLAY_WIDTH > width || y + DISPLAY_HEIGHT > height) {
+		return;
+	}
+	this->convertToRGBA(lut, graphics.getPixels() + x + y * width, width);
+}
@@ -0,0 +1,73 @@
+// indexedFrameBuffer.h - The picture the PPU outputs, stored as palette indices instead of RGBA colors.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <map>
+
+#include "graphics.h"
+
+constexpr size_t PALETTE_LUT_SIZE = 0x200;  // Every 9 bit color key (3 emphasis bits + a 6 bit palette index); see loadPalette.h.
+using PaletteLUT = std::array<uint32_t, PALETTE_LUT_SIZE>;
+
+// Flattens a palette loaded by loadPalette into a table indexed directly by color key. Palettes w/o emphasis entries (i.e. w/ 64
+// colors) reuse the unemphasized color for every emphasis combination; missing colors are black.
+PaletteLUT makePaletteLUT(const std::map<uint16_t, uint32_t>& paletteMap);
+
+/*
+A 256x240 picture where each pixel is the 9 bit color key the PPU picked for it: 0bBGRNNNNNN, the emphasis bits from PPUMASK
+followed by the index into the NES's palette (the same key loadPalette maps to colors).
+
+This is 2 bytes a pixel instead of 4 and the PPU does not need to look up any colors while rendering. Headless users (e.g. hashing,
+bots) can read the keys directly; converting to RGBA is deferred to when a frame is actually shown or exported (see convertToRGBA).
+
+Each line also has a hash, which the PPU updates as it finishes drawing the line (see finishLine), and a dirty flag saying whether
+the line changed this frame. Consumers can skip work for unchanged frames (isUnchanged) or lines, or compare the hashes against the
+ones of the last frame they used (e.g. a presenter which only uploads the lines which differ from what is on screen).
+*/
+class IndexedFrameBuffer {
+public:
+	IndexedFrameBuffer();
+	~IndexedFrameBuffer();
+
+	// Does no bounds checking; x must be < DISPLAY_WIDTH and y < DISPLAY_HEIGHT.
+	inline void setPixel(unsigned int x, unsigned int y, uint16_t colorKey) {
+		this->pixels[x + y * DISPLAY_WIDTH] = colorKey;
+	}
+	uint16_t getPixel(unsigned int x, unsigned int y) const;
+
+	// The DISPLAY_WIDTH * DISPLAY_HEIGHT color keys, row by row.
+	const uint16_t* getPixels() const;
+
+	void clear(uint16_t colorKey = 0x0f);  // 0x0f is black in every standard palette. Rehashes every line.
+
+	// Called by the PPU: beginFrame when it starts drawing a frame, finishLine after the last pixel of a line. finishLine rehashes 
+	// the line and marks it dirty if the hash changed.
+	void beginFrame();
+	void finishLine(unsigned int y);
+
+	uint64_t getLineHash(unsigned int y) const;
+	uint64_t getFrameHash() const;  // Combines the line hashes; equal frames have equal hashes.
+	bool isLineDirty(unsigned int y) const;  // Whether the line changed since beginFrame.
+	unsigned int getNumDirtyLines() const;
+	bool isUnchanged() const;  // Whether no line changed since beginFrame, i.e. the frame is the same as the last one.
+
+	// Converts the whole frame to RGBA8888 w/ the given table; pitch is the number of pixels between the starts of 2 rows in out.
+	void convertToRGBA(const PaletteLUT& lut, uint32_t* out, size_t pitch) const;
+	// Same as convertToRGBA but only for numLines lines starting at firstLine; out points to where firstLine goes.
+	void convertLinesToRGBA(const PaletteLUT& lut, unsigned int firstLine, unsigned int numLines, uint32_t* out, size_t pitch) const;
+	// Converts the frame into the given Graphics w/ its top-left corner at (x, y); does nothing if the frame would not fit.
+	void drawTo(Graphics& graphics, const PaletteLUT& lut, unsigned int x = 0, unsigned int y = 0) const;
+
+private:
+	uint64_t hashLine(unsigned int y) const;
+
+	std::array<uint16_t, DISPLAY_WIDTH * DISPLAY_HEIGHT> pixels;
+	std::array<uint64_t, DISPLAY_HEIGHT> lineHashes;
+	std::array<bool, DISPLAY_HEIGHT> dirtyLines;
+	unsigned int numDirtyLines;
+};
+
+// Converts count color keys to RGBA8888 colors w/ the given table. Uses AVX2 gathers when the CPU supports them.
+void convertColorKeys(const uint16_t* keys, uint32_t* out, size_t count, const PaletteLUT& lut);
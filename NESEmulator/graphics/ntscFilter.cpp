@@ -0,0 +1,235 @@
+#include "ntscFilter.h"
+
+#include "../globals/simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const double PI = 3.14159265358979323846;
+
+	// Voltages of the PPU's video signal (relative to sync) from NESdev's "NTSC video" page.
+	const double BLACK = 0.518, WHITE = 1.962, ATTENUATION = 0.746;
+	const double LEVELS[8] = { 0.350, 0.518, 0.962, 1.550,  // Low part of the square wave for each brightness.
+							   1.094, 1.506, 1.962, 1.962 };  // High part.
+
+	// The signal (0 = black, 1 = white) the PPU outputs for a color key at a given phase of the color subcarrier (0-11).
+	double signalLevel(uint16_t colorKey, unsigned int phase) {
+		int hue = colorKey & 0x0f;
+		int level = (colorKey >> 4) & 3;
+		int emphasis = (colorKey >> 6) & 7;
+		auto inColorPhase = [phase](int color) { return (color + phase) % 12 < 6; };
+
+		if (hue > 13) level = 1;  // Colors 0x0e and 0x0f are forced to brightness 1.
+		double low = LEVELS[level], high = LEVELS[4 + level];
+		if (hue == 0) low = high;  // Grays (only one voltage is output).
+		if (hue > 12) high = low;
+
+		double signal = inColorPhase(hue) ? high : low;
+		if (((emphasis & 1) && inColorPhase(0)) || ((emphasis & 2) && inColorPhase(4)) || ((emphasis & 4) && inColorPhase(8))) {
+			signal *= ATTENUATION;
+		}
+		return (signal - BLACK) / (WHITE - BLACK);
+	}
+
+	// Where the decoder's color reference (the TV's lock on the colorburst) sits relative to sample phase 0. Measured; it lines the 
+	// hues of flat colors up w/ the standard palette (2C02G_wiki.pal) to within a few levels per channel.
+	const double DECODER_PHASE = 114 * PI / 180;
+
+	constexpr unsigned int TABLE_ENTRY_SIZE = 16;  // 4 taps of 4 channels.
+	constexpr unsigned int PADDED_LINE_SIZE = (NTSC_OUTPUT_WIDTH + 3) * 4;  // The output pixels plus the taps which fall off each end, 4 channels each.
+
+#ifndef NES_SSE2
+	// Used on targets w/o SSE2 (see globals/simd.h).
+	// Adds each pixel's contributions into acc, where acc[4 * (o + 1)] is output pixel o's first channel.
+	void accumulateLineScalar(const uint16_t* keys, const float* table, unsigned int phase, float* acc) {
+		for (unsigned int x = 0; x < DISPLAY_WIDTH; ++x) {
+			const float* entry = table + ((keys[x] & (PALETTE_LUT_SIZE - 1)) * 3 + phase) * TABLE_ENTRY_SIZE;
+			float* out = acc + 8 * x;
+			for (unsigned int i = 0; i < TABLE_ENTRY_SIZE; ++i) {
+				out[i] += entry[i];
+			}
+			phase = phase >= 1 ? phase - 1 : 2;  // Each pixel starts 8 samples (2 thirds of a color cycle) after the last one.
+		}
+	}
+
+	void packLineScalar(const float* acc, uint32_t* out) {
+		auto toByte = [](float f) { return static_cast<uint32_t>(std::clamp(std::lround(f), 0l, 255l)); };
+		for (unsigned int o = 0; o < NTSC_OUTPUT_WIDTH; ++o) {
+			const float* channels = acc + 4 * (o + 1);
+			out[o] = toByte(channels[3]) << 24 | toByte(channels[2]) << 16 | toByte(channels[1]) << 8 | toByte(channels[0]);
+		}
+	}
+#else
+	void accumulateLineSSE2(const uint16_t* keys, const float* table, unsigned int phase, float* acc) {
+		for (unsigned int x = 0; x < DISPLAY_WIDTH; ++x) {
+			const float* entry = table + ((keys[x] & (PALETTE_LUT_SIZE - 1)) * 3 + phase) * TABLE_ENTRY_SIZE;
+			float* out = acc + 8 * x;
+			for (unsigned int tap = 0; tap < 4; ++tap) {
+				_mm_storeu_ps(out + 4 * tap, _mm_add_ps(_mm_loadu_ps(out + 4 * tap), _mm_loadu_ps(entry + 4 * tap)));
+			}
+			phase = phase >= 1 ? phase - 1 : 2;
+		}
+	}
+
+	// Rounds and saturates 4 output pixels at a time down to bytes; the channels are already in memory order.
+	void packLineSSE2(const float* acc, uint32_t* out) {
+		const float* channels = acc + 4;
+		for (unsigned int o = 0; o < NTSC_OUTPUT_WIDTH; o += 4) {
+			__m128i p0 = _mm_cvtps_epi32(_mm_loadu_ps(channels + 4 * o));
+			__m128i p1 = _mm_cvtps_epi32(_mm_loadu_ps(channels + 4 * o + 4));
+			__m128i p2 = _mm_cvtps_epi32(_mm_loadu_ps(channels + 4 * o + 8));
+			__m128i p3 = _mm_cvtps_epi32(_mm_loadu_ps(channels + 4 * o + 12));
+			__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), bytes);
+		}
+	}
+#endif
+
+#ifdef NES_X86_SIMD
+	// 2 taps per add.
+	NES_TARGET_AVX2 void accumulateLineAVX2(const uint16_t* keys, const float* table, unsigned int phase, float* acc) {
+		for (unsigned int x = 0; x < DISPLAY_WIDTH; ++x) {
+			const float* entry = table + ((keys[x] & (PALETTE_LUT_SIZE - 1)) * 3 + phase) * TABLE_ENTRY_SIZE;
+			float* out = acc + 8 * x;
+			_mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_loadu_ps(entry)));
+			_mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_loadu_ps(entry + 8)));
+			phase = phase >= 1 ? phase - 1 : 2;
+		}
+	}
+#endif
+
+	using AccumulateLineFunction = void(*)(const uint16_t*, const float*, unsigned int, float*);
+	using PackLineFunction = void(*)(const float*, uint32_t*);
+
+	AccumulateLineFunction chooseAccumulateLineFunction() {
+#ifdef NES_X86_SIMD
+		if (cpuSupportsAVX2()) {
+			return accumulateLineAVX2;
+		}
+#endif
+#ifdef NES_SSE2
+		return accumulateLineSSE2;
+#else
+		return accumulateLineScalar;
+#endif
+	}
+
+	PackLineFunction choosePackLineFunction() {
+#ifdef NES_SSE2
+		return packLineSSE2;
+#else
+		return packLineScalar;
+#endif
+	}
+}
+
+NTSCFilter::NTSCFilter(NTSCSettings settings) : settings(settings) {
+	this->buildTables();
+}
+NTSCFilter::~NTSCFilter() {}
+
+void NTSCFilter::setSettings(NTSCSettings settings) {
+	this->settings = settings;
+	this->buildTables();
+}
+
+NTSCSettings NTSCFilter::getSettings() const {
+	return this->settings;
+}
+
+void NTSCFilter::filter(const IndexedFrameBuffer& frame, uint32_t* out, size_t pitch, unsigned long long frameNumber) const {
+	static const AccumulateLineFunction accumulateLine = chooseAccumulateLineFunction();
+	static const PackLineFunction packLine = choosePackLineFunction();
+
+	// A scanline is 341 * 8 samples long, so each line starts 4 samples further into the color cycle than the last. Consecutive
+	// frames start 4 or 8 samples apart (the odd frames are a pixel shorter), i.e. they alternate between 2 phases.
+	unsigned int framePhase = this->settings.alternatePhase ? static_cast<unsigned int>(frameNumber & 1) : 0;
+
+	float acc[PADDED_LINE_SIZE];
+	for (unsigned int y = 0; y < DISPLAY_HEIGHT; ++y) {
+		for (unsigned int i = 0; i < PADDED_LINE_SIZE; i += 4) {
+			acc[i] = 255;  // A; the contributions never add to it.
+			acc[i + 1] = acc[i + 2] = acc[i + 3] = 0;
+		}
+
+		accumulateLine(frame.getPixels() + y * DISPLAY_WIDTH, this->contributions.data(), (y + framePhase) % NUM_PHASES, acc);
+		packLine(acc, out + y * pitch);
+	}
+}
+
+void NTSCFilter::buildTables() {
+	this->contributions.assign(PALETTE_LUT_SIZE * NUM_PHASES * TABLE_ENTRY_SIZE, 0.0f);
+
+	const double hue = DECODER_PHASE + this->settings.hue * PI / 180;
+	for (uint16_t colorKey = 0; colorKey < PALETTE_LUT_SIZE; ++colorKey) {
+		for (unsigned int phase = 0; phase < NUM_PHASES; ++phase) {
+			float* entry = &this->contributions[(colorKey * NUM_PHASES + phase) * TABLE_ENTRY_SIZE];
+
+			for (int tap = 0; tap < static_cast<int>(NUM_TAPS); ++tap) {
+				// Relative to the pixel's first sample, output pixel 2x + tap - 1 is decoded from samples 4 * (tap - 1) - 4 to 4 * (tap - 1) + 7.
+				int windowStart = 4 * (tap - 1) - 4;
+				double y = 0, i = 0, q = 0;
+				for (int sample = std::max(windowStart, 0); sample < std::min(windowStart + 12, 8); ++sample) {
+					unsigned int samplePhase = (4 * phase + sample) % 12;
+					double level = signalLevel(colorKey, samplePhase) / 12;
+					y += level;
+					i += level * std::cos(PI * samplePhase / 6 + hue);
+					q += level * std::sin(PI * samplePhase / 6 + hue);
+				}
+				i *= 2 * this->settings.saturation;  // The sums only pick up half of the carrier's amplitude.
+				q *= 2 * this->settings.saturation;
+
+				// YIQ to RGB (FCC matrix), stored in memory order (A, B, G, R).
+				float* channels = entry + 4 * tap;
+				channels[3] = static_cast<float>(255 * (y + 0.946882 * i + 0.623557 * q));
+				channels[2] = static_cast<float>(255 * (y - 0.274788 * i - 0.635691 * q));
+				channels[1] = static_cast<float>(255 * (y - 1.108545 * i + 1.709007 * q));
+			}
+		}
+	}
+}
+
+NTSCFilterThread::NTSCFilterThread(NTSCSettings settings) : filter(settings), submissions(0), running(true) {
+	this->thread = std::thread(&NTSCFilterThread::run, this);
+}
+
+NTSCFilterThread::~NTSCFilterThread() {
+	this->running = false;
+	++this->submissions;
+	this->submissions.notify_one();
+	this->thread.join();
+}
+
+void NTSCFilterThread::submit(const IndexedFrameBuffer& frame) {
+	this->input.getWriteBuffer() = frame;
+	this->input.publish();
+	++this->submissions;
+	this->submissions.notify_one();
+}
+
+bool NTSCFilterThread::update() {
+	return this->output.update();
+}
+
+const uint32_t* NTSCFilterThread::getOutput() const {
+	return this->output.getReadBuffer().pixels.data();
+}
+
+void NTSCFilterThread::run() {
+	unsigned long long seen = 0;
+	unsigned long long framesFiltered = 0;
+	while (true) {
+		this->submissions.wait(seen);
+		seen = this->submissions.load();
+		if (!this->running) {
+			return;
+		}
+		if (!this->input.update()) {
+			continue;
+		}
+
+		this->filter.filter(this->input.getReadBuffer(), this->output.getWriteBuffer().pixels.data(), NTSC_OUTPUT_WIDTH, framesFiltered++);
+		this->output.publish();
+	}
+}
@@ -0,0 +1,87 @@
+// ntscFilter.h - Approximates how the NES's picture looks on a TV over composite video.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "indexedFrameBuffer.h"
+#include "../globals/tripleBuffer.hpp"
+
+constexpr unsigned int NTSC_OUTPUT_WIDTH = DISPLAY_WIDTH * 2;  // The filter outputs 2 pixels for every pixel of the NES's picture.
+
+struct NTSCSettings {
+	double hue = 0;  // In degrees.
+	double saturation = 1;
+	bool alternatePhase = true;  // Whether the color subcarrier's phase alternates between frames like on a real NES (this makes the artifacts crawl).
+};
+
+/*
+The PPU does not output RGB; each pixel is 8 samples of a square wave whose phase is the pixel's hue and whose voltages are its 
+brightness, and the TV decodes color from 12 sample (one color cycle) windows of it. Since each window straddles pixels, colors bleed 
+into their neighbours and fine patterns turn into color fringes. See NESdev's "NTSC video" page.
+
+Decoding is linear in the signal, so each pixel's share of the output can be worked out ahead of time: at 2 output pixels per input 
+pixel, a pixel's 8 samples only fall into the windows of 4 output pixels. The filter precomputes those 4 RGB contributions for every 
+color key (see IndexedFrameBuffer) and each of the 3 phases a pixel can start on, so filtering a line is just adding 4 table entries 
+per pixel into the output (w/ AVX2 or SSE2 when available), then clamping and packing the sums into RGBA.
+*/
+class NTSCFilter {
+public:
+	NTSCFilter(NTSCSettings settings = NTSCSettings());
+	~NTSCFilter();
+
+	void setSettings(NTSCSettings settings);  // Recomputes the tables.
+	NTSCSettings getSettings() const;
+
+	// Filters the frame into NTSC_OUTPUT_WIDTH x DISPLAY_HEIGHT RGBA8888 pixels; pitch is in pixels. frameNumber only picks the phase.
+	void filter(const IndexedFrameBuffer& frame, uint32_t* out, size_t pitch, unsigned long long frameNumber) const;
+
+private:
+	static constexpr unsigned int NUM_PHASES = 3;  // Pixels are 8 samples long and color cycles 12, so a pixel starts on sample 0, 4 or 8 of a cycle.
+	static constexpr unsigned int NUM_TAPS = 4;  // Output pixels 2x - 1 to 2x + 2.
+
+	void buildTables();
+
+	NTSCSettings settings;
+	// For each color key, phase and tap: how much the pixel adds to the output's channels, in the order the bytes of an RGBA8888 
+	// pixel are in memory on a little-endian CPU (A, B, G, R); the A channel is always 0.
+	std::vector<float> contributions;
+};
+
+/*
+Runs an NTSCFilter on its own thread. submit copies a frame in and returns right away; the thread filters the newest frame 
+submitted and publishes the result, which getOutput returns after update. Frames submitted faster than they can be filtered are 
+skipped, never queued.
+
+Only one thread may submit and only one thread may call update/getOutput (they may be the same thread).
+*/
+class NTSCFilterThread {
+public:
+	NTSCFilterThread(NTSCSettings settings = NTSCSettings());
+	~NTSCFilterThread();  // Stops and joins the thread.
+
+	void submit(const IndexedFrameBuffer& frame);
+
+	// Takes the newest filtered frame if there is a new one; returns whether the output changed.
+	bool update();
+	// NTSC_OUTPUT_WIDTH x DISPLAY_HEIGHT RGBA8888 pixels (black until a frame has been filtered).
+	const uint32_t* getOutput() const;
+
+private:
+	struct FilteredFrame {
+		std::vector<uint32_t> pixels = std::vector<uint32_t>(NTSC_OUTPUT_WIDTH * DISPLAY_HEIGHT, 0x000000ff);
+	};
+
+	void run();
+
+	NTSCFilter filter;
+	TripleBuffer<IndexedFrameBuffer> input;
+	TripleBuffer<FilteredFrame> output;
+
+	std::atomic<unsigned long long> submissions;  // Waited on by the thread while there is nothing to filter.
+	std::atomic<bool> running;
+	std::thread thread;
+};
@@ -0,0 +1,251 @@
+#include "scaler.h"
+
+#include "../globals/simd.h"
+
+#include <cstring>
+
+namespace {
+	// --- Nearest neighbour --- //
+
+	void scaleRowScalar(const uint32_t* src, unsigned int start, unsigned int w, uint32_t* dst, unsigned int factor) {
+		for (unsigned int x = start; x < w; ++x) {
+			for (unsigned int i = 0; i < factor; ++i) {
+				dst[x * factor + i] = src[x];
+			}
+		}
+	}
+
+	// The vectorized row functions handle factors 2-4 and return how many pixels they did; the scalar code does the rest.
+#ifndef NES_SSE2
+	unsigned int scaleRowNone(const uint32_t*, unsigned int, uint32_t*, unsigned int) {
+		return 0;
+	}
+#else
+	unsigned int scaleRowSSE2(const uint32_t* src, unsigned int w, uint32_t* dst, unsigned int factor) {
+		unsigned int x = 0;
+		for (; x + 4 <= w; x += 4) {
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+			__m128i* out = reinterpret_cast<__m128i*>(dst + x * factor);
+			switch (factor) {
+			case 2:  // p0 p0 p1 p1 | p2 p2 p3 p3
+				_mm_storeu_si128(out, _mm_unpacklo_epi32(p, p));
+				_mm_storeu_si128(out + 1, _mm_unpackhi_epi32(p, p));
+				break;
+			case 3:  // p0 p0 p0 p1 | p1 p1 p2 p2 | p2 p3 p3 p3
+				_mm_storeu_si128(out, _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 0, 0, 0)));
+				_mm_storeu_si128(out + 1, _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 2, 1, 1)));
+				_mm_storeu_si128(out + 2, _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 2)));
+				break;
+			case 4:
+				_mm_storeu_si128(out, _mm_shuffle_epi32(p, _MM_SHUFFLE(0, 0, 0, 0)));
+				_mm_storeu_si128(out + 1, _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 1, 1, 1)));
+				_mm_storeu_si128(out + 2, _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 2, 2, 2)));
+				_mm_storeu_si128(out + 3, _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 3)));
+				break;
+			default:
+				return x;
+			}
+		}
+		return x;
+	}
+#endif
+
+#ifdef NES_X86_SIMD
+	// Same as the SSE2 version but w/ 8 pixels at a time; the permutes pick which source pixel goes into each output lane.
+	NES_TARGET_AVX2 unsigned int scaleRowAVX2(const uint32_t* src, unsigned int w, uint32_t* dst, unsigned int factor) {
+		if (factor < 2 || factor > 4) {
+			return 0;
+		}
+
+		const __m256i lanes[3][4] = {
+			{ _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3), _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7) },
+			{ _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2), _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5), _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7) },
+			{ _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1), _mm256_setr_epi32(2, 2, 2, 2, 3, 3, 3, 3), 
+			  _mm256_setr_epi32(4, 4, 4, 4, 5, 5, 5, 5), _mm256_setr_epi32(6, 6, 6, 6, 7, 7, 7, 7) },
+		};
+		const __m256i* factorLanes = lanes[factor - 2];
+
+		unsigned int x = 0;
+		for (; x + 8 <= w; x += 8) {
+			__m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x));
+			__m256i* out = reinterpret_cast<__m256i*>(dst + x * factor);
+			for (unsigned int i = 0; i < factor; ++i) {
+				_mm256_storeu_si256(out + i, _mm256_permutevar8x32_epi32(p, factorLanes[i]));
+			}
+		}
+		return x;
+	}
+#endif
+
+	using ScaleRowFunction = unsigned int(*)(const uint32_t*, unsigned int, uint32_t*, unsigned int);
+
+	ScaleRowFunction chooseScaleRowFunction() {
+#ifdef NES_X86_SIMD
+		if (cpuSupportsAVX2()) {
+			return scaleRowAVX2;
+		}
+#endif
+#ifdef NES_SSE2
+		return scaleRowSSE2;
+#else
+		return scaleRowNone;
+#endif
+	}
+
+	// --- Scale2x --- //
+
+	/* For a pixel E w/ the neighbours
+		  B
+		D E F
+		  H
+	each of its 4 output pixels takes the color of the 2 neighbours touching it if they match (and the pixel is not in the middle of
+	a flat area or a straight line), which rounds off diagonal edges. */
+	inline void scale2xPixel(uint32_t B, uint32_t D, uint32_t E, uint32_t F, uint32_t H, uint32_t* top, uint32_t* bottom) {
+		if (B != H && D != F) {
+			top[0] = D == B ? D : E;
+			top[1] = B == F ? F : E;
+			bottom[0] = D == H ? D : E;
+			bottom[1] = H == F ? F : E;
+		} else {
+			top[0] = top[1] = bottom[0] = bottom[1] = E;
+		}
+	}
+
+	// Pixels on the edges of the frame use themselves as their missing neighbours.
+	void scale2xRowScalar(const uint32_t* above, const uint32_t* row, const uint32_t* below, unsigned int start, unsigned int end, unsigned int w,
+						  uint32_t* top, uint32_t* bottom) {
+		for (unsigned int x = start; x < end; ++x) {
+			uint32_t D = x > 0 ? row[x - 1] : row[x];
+			uint32_t F = x + 1 < w ? row[x + 1] : row[x];
+			scale2xPixel(above[x], D, row[x], F, below[x], top + 2 * x, bottom + 2 * x);
+		}
+	}
+
+#ifdef NES_SSE2
+	inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// Does 4 pixels at a time starting at pixel 1 (pixel 0 has no left neighbour); returns where it stopped.
+	unsigned int scale2xRowSSE2(const uint32_t* above, const uint32_t* row, const uint32_t* below, unsigned int w, uint32_t* top, uint32_t* bottom) {
+		unsigned int x = 1;
+		for (; x + 5 <= w; x += 4) {  // The right neighbours go up to x + 4, which must be inside the row.
+			__m128i B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + x));
+			__m128i H = _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + x));
+			__m128i D = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 1));
+			__m128i E = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+			__m128i F = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 1));
+
+			__m128i edge = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F)), _mm_set1_epi32(-1));
+			__m128i E0 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(D, B)), D, E);
+			__m128i E1 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(B, F)), F, E);
+			__m128i E2 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(D, H)), D, E);
+			__m128i E3 = select(_mm_and_si128(edge, _mm_cmpeq_epi32(H, F)), F, E);
+
+			// Interleave the left and right halves of each output pixel.
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(top + 2 * x), _mm_unpacklo_epi32(E0, E1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(top + 2 * x + 4), _mm_unpackhi_epi32(E0, E1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + 2 * x), _mm_unpacklo_epi32(E2, E3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + 2 * x + 4), _mm_unpackhi_epi32(E2, E3));
+		}
+		return x;
+	}
+#endif
+}
+
+void scaleNearest(const uint32_t* src, unsigned int w, unsigned int h, size_t srcPitch, uint32_t* dst, size_t dstPitch, unsigned int factor) {
+	static const ScaleRowFunction scaleRow = chooseScaleRowFunction();
+	if (factor == 0) {
+		return;
+	}
+
+	for (unsigned int y = 0; y < h; ++y) {
+		const uint32_t* srcRow = src + y * srcPitch;
+		uint32_t* dstRow = dst + y * factor * dstPitch;
+
+		unsigned int x = scaleRow(srcRow, w, dstRow, factor);
+		scaleRowScalar(srcRow, x, w, dstRow, factor);
+
+		// The rest of the block's rows are the same as the first.
+		for (unsigned int i = 1; i < factor; ++i) {
+			std::memcpy(dstRow + i * dstPitch, dstRow, w * factor * sizeof(uint32_t));
+		}
+	}
+}
+
+void scale2x(const uint32_t* src, unsigned int w, unsigned int h, size_t srcPitch, uint32_t* dst, size_t dstPitch) {
+	for (unsigned int y = 0; y < h; ++y) {
+		const uint32_t* row = src + y * srcPitch;
+		const uint32_t* above = y > 0 ? row - srcPitch : row;
+		const uint32_t* below = y + 1 < h ? row + srcPitch : row;
+		uint32_t* top = dst + 2 * y * dstPitch;
+		uint32_t* bottom = top + dstPitch;
+
+		unsigned int x = w < 1 ? w : 1;
+		scale2xRowScalar(above, row, below, 0, x, w, top, bottom);
+#ifdef NES_SSE2
+		x = scale2xRowSSE2(above, row, below, w, top, bottom);
+#endif
+		scale2xRowScalar(above, row, below, x, w, w, top, bottom);
+	}
+}
+
+FrameScaler::FrameScaler(ScaleFilter::ScaleFilter filter, unsigned int factor) : filter(filter), factor(1), outputW(0), outputH(0) {
+	this->setFilter(filter, factor);
+}
+FrameScaler::~FrameScaler() {}
+
+void FrameScaler::setFilter(ScaleFilter::ScaleFilter filter, unsigned int factor) {
+	this->filter = filter;
+	switch (filter) {
+	case ScaleFilter::SCALE2X:
+		this->factor = factor >= 4 ? 4 : 2;
+		break;
+	default:
+		this->factor = factor > 0 ? factor : 1;
+		break;
+	}
+}
+
+ScaleFilter::ScaleFilter FrameScaler::getFilter() const {
+	return this->filter;
+}
+
+unsigned int FrameScaler::getFactor() const {
+	return this->factor;
+}
+
+const uint32_t* FrameScaler::scale(const uint32_t* src, unsigned int w, unsigned int h, size_t srcPitch) {
+	this->outputW = w * this->factor;
+	this->outputH = h * this->factor;
+	if (this->output.size() != static_cast<size_t>(this->outputW) * this->outputH) {
+		this->output.resize(static_cast<size_t>(this->outputW) * this->outputH);
+	}
+
+	switch (this->filter) {
+	case ScaleFilter::SCALE2X:
+		if (this->factor == 4) {
+			if (this->intermediate.size() != static_cast<size_t>(w) * h * 4) {
+				this->intermediate.resize(static_cast<size_t>(w) * h * 4);
+			}
+			scale2x(src, w, h, srcPitch, this->intermediate.data(), w * 2);
+			scale2x(this->intermediate.data(), w * 2, h * 2, w * 2, this->output.data(), this->outputW);
+		} else {
+			scale2x(src, w, h, srcPitch, this->output.data(), this->outputW);
+		}
+		break;
+	default:
+		scaleNearest(src, w, h, srcPitch, this->output.data(), this->outputW, this->factor);
+		break;
+	}
+
+	return this->output.data();
+}
+
+unsigned int FrameScaler::getOutputWidth() const {
+	return this->outputW;
+}
+
+unsigned int FrameScaler::getOutputHeight() const {
+	return this->outputH;
+}
@@ -0,0 +1,48 @@
+// scaler.h - Enlarges RGBA8888 frames (e.g. a converted IndexedFrameBuffer) before they are shown.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace ScaleFilter {
+	enum ScaleFilter {
+		NEAREST,  // Each pixel becomes a factor x factor block; any factor.
+		SCALE2X,  // The Scale2x (AdvMAME2x) pixel-art filter, which rounds off diagonal edges. Factors of 2 or 4 (applied twice).
+	};
+};
+
+// The scaling kernels; pitches are in pixels. dst must have room for (w * factor) x (h * factor) pixels. 
+// These use SSE2 and, when the CPU has it, AVX2 on x86 and plain C++ elsewhere; they never allocate.
+void scaleNearest(const uint32_t* src, unsigned int w, unsigned int h, size_t srcPitch, uint32_t* dst, size_t dstPitch, unsigned int factor);
+void scale2x(const uint32_t* src, unsigned int w, unsigned int h, size_t srcPitch, uint32_t* dst, size_t dstPitch);
+
+/*
+Scales frames w/ a chosen filter into a buffer it owns. The buffers are only (re)allocated when the input size, filter or factor 
+changes, so scaling a stream of same-sized frames allocates nothing after the first one.
+*/
+class FrameScaler {
+public:
+	FrameScaler(ScaleFilter::ScaleFilter filter = ScaleFilter::NEAREST, unsigned int factor = 2);
+	~FrameScaler();
+
+	// Factors are clamped to what the filter supports (see ScaleFilter); a factor of 1 (w/ NEAREST) just copies the frame.
+	void setFilter(ScaleFilter::ScaleFilter filter, unsigned int factor);
+	ScaleFilter::ScaleFilter getFilter() const;
+	unsigned int getFactor() const;
+
+	// Scales the w x h frame and returns the result, which is getOutputWidth() x getOutputHeight() pixels stored row by row 
+	// (the pitch is the width). The result is valid until the next call.
+	const uint32_t* scale(const uint32_t* src, unsigned int w, unsigned int h, size_t srcPitch);
+
+	unsigned int getOutputWidth() const;
+	unsigned int getOutputHeight() const;
+
+private:
+	ScaleFilter::ScaleFilter filter;
+	unsigned int factor;
+
+	unsigned int outputW, outputH;
+	std::vector<uint32_t> output;
+	std::vector<uint32_t> intermediate;  // Holds the 2x frame when Scale2x is applied twice.
+};
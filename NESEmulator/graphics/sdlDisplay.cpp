@@ -0,0 +1,161 @@
+#include "sdlDisplay.h"
+
+#include <cstring>
+
+void blitDisplay(const Graphics& graphics, SDL_Surface* windowSurface) {
+	// Wraps the framebuffer in a surface w/o copying it; SDL never writes to a blit's source, so the const_cast is safe.
+	SDL_Surface* display = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(graphics.getPixels()), graphics.w, graphics.h, 32, 
+															   graphics.w * sizeof(uint32_t), SDL_PIXELFORMAT_RGBA8888);
+	if (display == nullptr) {
+		return;
+	}
+
+	Rect bounds = graphics.getDisplayBounds();
+	SDL_Rect displayBounds{ bounds.x, bounds.y, bounds.w, bounds.h };
+	SDL_BlitScaled(display, &displayBounds, windowSurface, nullptr);
+	SDL_FreeSurface(display);
+}
+
+TexturePresenter::TexturePresenter(SDL_Window* window, int logicalW, int logicalH, bool vsync) :
+	renderer(nullptr),
+	accelerated(true),
+	frameTexture(nullptr),
+	frameTextureHashes{},
+	frameTextureLUT(nullptr),
+	frameTextureValid(false),
+	graphicsTexture(nullptr),
+	pixelsTexture(nullptr)
+{
+	Uint32 vsyncFlag = vsync ? SDL_RENDERER_PRESENTVSYNC : 0;
+	this->renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | vsyncFlag);
+	if (this->renderer == nullptr) {
+		this->renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | vsyncFlag);
+		this->accelerated = false;
+	}
+	if (this->renderer == nullptr) {
+		return;
+	}
+
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");  // Keeps the pixels sharp; must be set before textures are created.
+	SDL_RenderSetLogicalSize(this->renderer, logicalW, logicalH);
+	SDL_SetRenderDrawColor(this->renderer, 0, 0, 0, 0xff);
+	SDL_RenderClear(this->renderer);
+}
+
+TexturePresenter::~TexturePresenter() {
+	if (this->frameTexture != nullptr) {
+		SDL_DestroyTexture(this->frameTexture);
+	}
+	if (this->graphicsTexture != nullptr) {
+		SDL_DestroyTexture(this->graphicsTexture);
+	}
+	if (this->pixelsTexture != nullptr) {
+		SDL_DestroyTexture(this->pixelsTexture);
+	}
+	if (this->renderer != nullptr) {
+		SDL_DestroyRenderer(this->renderer);
+	}
+}
+
+bool TexturePresenter::isValid() const {
+	return this->renderer != nullptr;
+}
+
+bool TexturePresenter::isAccelerated() const {
+	return this->renderer != nullptr && this->accelerated;
+}
+
+void TexturePresenter::drawFrame(const IndexedFrameBuffer& frame, const PaletteLUT& lut, Rect dest) {
+	SDL_Texture* oldTexture = this->frameTexture;
+	SDL_Texture* texture = this->getTexture(this->frameTexture, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+	if (texture == nullptr) {
+		return;
+	}
+	bool reuploadAll = texture != oldTexture || !this->frameTextureValid || this->frameTextureLUT != &lut;
+
+	// Uploads each run of consecutive lines which differ from what is in the texture w/ one lock.
+	unsigned int line = 0;
+	while (line < DISPLAY_HEIGHT) {
+		if (!reuploadAll && frame.getLineHash(line) == this->frameTextureHashes[line]) {
+			++line;
+			continue;
+		}
+		unsigned int firstLine = line;
+		while (line < DISPLAY_HEIGHT && (reuploadAll || frame.getLineHash(line) != this->frameTextureHashes[line])) {
+			this->frameTextureHashes[line] = frame.getLineHash(line);
+			++line;
+		}
+
+		SDL_Rect lines{ 0, static_cast<int>(firstLine), DISPLAY_WIDTH, static_cast<int>(line - firstLine) };
+		void* pixels;
+		int pitch;
+		if (SDL_LockTexture(texture, &lines, &pixels, &pitch) != 0) {
+			this->frameTextureValid = false;  // Whatever is in the texture is unknown now.
+			return;
+		}
+		frame.convertLinesToRGBA(lut, firstLine, line - firstLine, static_cast<uint32_t*>(pixels), pitch / sizeof(uint32_t));
+		SDL_UnlockTexture(texture);
+	}
+	this->frameTextureLUT = &lut;
+	this->frameTextureValid = true;
+
+	SDL_Rect destRect{ dest.x, dest.y, dest.w, dest.h };
+	SDL_RenderCopy(this->renderer, texture, nullptr, &destRect);
+}
+
+void TexturePresenter::drawGraphics(const Graphics& graphics, Rect dest) {
+	Rect bounds = graphics.getDisplayBounds();
+	const uint32_t* firstPixel = graphics.getPixels() + bounds.x + bounds.y * graphics.w;
+	this->copyToTexture(this->graphicsTexture, firstPixel, bounds.w, bounds.h, graphics.w, dest);
+}
+
+void TexturePresenter::drawPixels(const uint32_t* pixels, int w, int h, size_t pitch, Rect dest) {
+	this->copyToTexture(this->pixelsTexture, pixels, w, h, pitch, dest);
+}
+
+void TexturePresenter::present() {
+	if (this->renderer == nullptr) {
+		return;
+	}
+	SDL_RenderPresent(this->renderer);
+	SDL_RenderClear(this->renderer);
+}
+
+SDL_Texture* TexturePresenter::getTexture(SDL_Texture*& texture, int w, int h) {
+	if (this->renderer == nullptr) {
+		return nullptr;
+	}
+
+	if (texture != nullptr) {
+		int textureW, textureH;
+		SDL_QueryTexture(texture, nullptr, nullptr, &textureW, &textureH);
+		if (textureW == w && textureH == h) {
+			return texture;
+		}
+		SDL_DestroyTexture(texture);
+	}
+
+	// Graphics' pixels are 0xRRGGBBAA in native order, which is what SDL calls RGBA8888.
+	texture = SDL_CreateTexture(this->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+	return texture;
+}
+
+void TexturePresenter::copyToTexture(SDL_Texture*& texture, const uint32_t* pixels, int w, int h, size_t pitch, Rect dest) {
+	SDL_Texture* target = this->getTexture(texture, w, h);
+	if (target == nullptr) {
+		return;
+	}
+
+	void* targetPixels;
+	int targetPitch;
+	if (SDL_LockTexture(target, nullptr, &targetPixels, &targetPitch) != 0) {
+		return;
+	}
+	for (int row = 0; row < h; ++row) {
+		std::memcpy(static_cast<uint8_t*>(targetPixels) + row * targetPitch, pixels + row * pitch, w * sizeof(uint32_t));
+	}
+	SDL_UnlockTexture(target);
+
+	SDL_Rect destRect{ dest.x, dest.y, dest.w, dest.h };
+	SDL_RenderCopy(this->renderer, target, nullptr, &destRect);
+}
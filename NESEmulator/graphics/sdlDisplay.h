@@ -0,0 +1,55 @@
+// sdlDisplay.h - Displays a Graphics framebuffer w/ SDL; part of the SDL frontend, not of the emulator core.
+#pragma once
+
+#include <SDL.h>
+
+#include "graphics.h"
+#include "indexedFrameBuffer.h"
+
+// Copies the displayed part of the given framebuffer to the window surface, scaling it to fit.
+void blitDisplay(const Graphics& graphics, SDL_Surface* windowSurface);
+
+/*
+Presents through an SDL_Renderer instead of the window surface; the renderer does the scaling (on the GPU if there is one) and 
+can wait for vsync. Falls back to SDL's software renderer when no accelerated one can be created.
+
+Everything is drawn onto a canvas of logicalW x logicalH pixels which the renderer scales to fit the window (keeping the aspect 
+ratio). Each draw call copies its pixels into a streaming texture (converting an IndexedFrameBuffer straight into the locked 
+texture, so the frame is never copied into a Graphics first), then the canvas is shown w/ present.
+
+NOTE: A window must not be used w/ both a TexturePresenter and blitDisplay (SDL_GetWindowSurface).
+*/
+class TexturePresenter {
+public:
+	TexturePresenter(SDL_Window* window, int logicalW, int logicalH, bool vsync = false);
+	~TexturePresenter();
+
+	bool isValid() const;  // Whether the renderer was created; if not, nothing is drawn.
+	bool isAccelerated() const;
+
+	// Draws the frame at the given place on the canvas (scaled to fit dest). Only the lines which differ from the last frame drawn
+	// (going by the frame's line hashes) are uploaded to the texture.
+	void drawFrame(const IndexedFrameBuffer& frame, const PaletteLUT& lut, Rect dest);
+	// Draws the displayed part of graphics at the given place on the canvas (scaled to fit dest).
+	void drawGraphics(const Graphics& graphics, Rect dest);
+	// Draws w x h RGBA8888 pixels (e.g. the output of a FrameScaler; pitch is in pixels) at the given place on the canvas (scaled to fit dest).
+	void drawPixels(const uint32_t* pixels, int w, int h, size_t pitch, Rect dest);
+	// Shows what has been drawn since the last present, waiting for vsync if enabled, then clears the canvas.
+	void present();
+
+private:
+	// Returns texture if it is already w x h, otherwise replaces it w/ a new streaming texture of that size.
+	SDL_Texture* getTexture(SDL_Texture*& texture, int w, int h);
+	void copyToTexture(SDL_Texture*& texture, const uint32_t* pixels, int w, int h, size_t pitch, Rect dest);
+
+	SDL_Renderer* renderer;
+	bool accelerated;
+
+	SDL_Texture* frameTexture;
+	// What is in frameTexture: the line hashes of the frame and the LUT it was converted w/. Only meaningful if frameTextureValid.
+	std::array<uint64_t, DISPLAY_HEIGHT> frameTextureHashes;
+	const PaletteLUT* frameTextureLUT;
+	bool frameTextureValid;
+	SDL_Texture* graphicsTexture;
+	SDL_Texture* pixelsTexture;
+};
@@ -1,13 +1,8 @@
 #include "controller.h"
 
 #include "../globals/helpers.hpp"
-#include "../input/input.h"
-
-#include <SDL.h>
-#include <map>
 
 _4021::_4021() : ctrl(true), bits(0x00) {}
-_4021::~_4021() {}
 
 void _4021::clock(bool serial_in) {
 	// If ctrl is false, left-shift it and replace Q1 (bit 0 of bits) w/ serial_in.
@@ -30,37 +25,31 @@ void _4021::setCtrl(bool ctrl) {
 	this->ctrl = ctrl;
 }
 
+bool _4021::getCtrl() const {
+	return this->ctrl;
+}
+
 void _4021::setRegister(uint8_t bits) {
 	if (ctrl) {
 		this->bits = bits;
 	}
 }
 
-StandardController::StandardController() : input_values(0xff), shift_register() {}
+uint8_t _4021::getRegister() const {
+	return this->bits;
+}
+
+StandardController::StandardController() : input_values(0), shift_register() {}  // No buttons are held until told otherwise.
 
 StandardController::~StandardController() {}
 
-void StandardController::readInput(Input& input) {
-	// On the controller, 1 indicates a button is UP, and 0 indicates a button is DOWN; this is inverted by the NES.
-	
-	// Maps SDL_Scancodes to NES buttons stored as a byte w/ 1 bit toggled.
-	const std::map<SDL_Scancode, uint8_t> KEY_BUTTON_MAP = { { SDL_SCANCODE_RIGHT, 0b0000'0001 },  
- 															 { SDL_SCANCODE_LEFT,  0b0000'0010 },
- 															 { SDL_SCANCODE_DOWN,  0b0000'0100 },
-															 { SDL_SCANCODE_UP,    0b0000'1000 },
-															 { SDL_SCANCODE_W,     0b0001'0000 },   // Start
-															 { SDL_SCANCODE_Q,     0b0010'0000 },   // Select
-															 { SDL_SCANCODE_S,     0b0100'0000 },   // B
-															 { SDL_SCANCODE_A,     0b1000'0000 } }; // A
-	this->input_values = 0x00;  // The ORed bits of the input according to the map.
-
-	// For every key being checked, if it is down or held, OR it with the byte indicating which keys are held.
-	for (auto const& [key, val] : KEY_BUTTON_MAP) {
-		KeyState key_state = input.getKeyState(key);
-		if (key_state == PRESSED || key_state == HELD) {
-			this->input_values |= val;
-		}
-	}
+void StandardController::setButtons(uint8_t buttons) {
+	// NOTE: On the controller, 1 indicates a button is UP, and 0 indicates a button is DOWN; this is inverted when transferred to the 4021.
+	this->input_values = buttons;
+}
+
+uint8_t StandardController::getButtons() const {
+	return this->input_values;
 }
 
 void StandardController::update4021() {
@@ -72,9 +61,25 @@ void StandardController::clock() {
 }
 
 void StandardController::setLatch(bool value) {
+	// NOTE: When the latch falls, the 4021 keeps what it had taken in up to then, so it takes in the buttons first; when it rises, 
+	// it takes them in right away. update4021 does nothing while the latch is low, so calling it on both sides covers both.
+	this->update4021();
 	this->shift_register.setCtrl(value);
+	this->update4021();
+}
+
+bool StandardController::getLatch() const {
+	return this->shift_register.getCtrl();
 }
 
 bool StandardController::getData() const {
 	return this->shift_register.readOut(8);
 }
+
+_4021 StandardController::getShiftRegister() const {
+	return this->shift_register;
+}
+
+void StandardController::loadShiftRegister(const _4021& shiftRegister) {
+	this->shift_register = shiftRegister;
+}
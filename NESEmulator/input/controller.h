@@ -6,13 +6,24 @@ all NES controllers later.
 
 #include <stdint.h>
 
-class Input;
+// The bit each button occupies in the byte given to StandardController::setButtons (1 = held).
+namespace ControllerButtons {
+	enum ControllerButtons : uint8_t {
+		RIGHT = 0b0000'0001,
+		LEFT = 0b0000'0010,
+		DOWN = 0b0000'0100,
+		UP = 0b0000'1000,
+		START = 0b0001'0000,
+		SELECT = 0b0010'0000,
+		B = 0b0100'0000,
+		A = 0b1000'0000
+	};
+};
 
 // 8-bit shift register associated w/ the StandardController.
 class _4021 {
 public:
 	_4021();
-	~_4021();
 
 	// Clocks the shift unit if ctrl only if false (serial mode); replaces Q1 w/ serial_in.
 	void clock(bool serial_in);
@@ -26,6 +37,7 @@ public:
 
 	// Sets the register bits to the given bits ONLY IF ctrl is true (parallel mode).
 	void setRegister(uint8_t bits);
+	uint8_t getRegister() const;
 
 private:
 
@@ -37,25 +49,39 @@ private:
 	uint8_t bits;
 };
 
-// Standard NES controller class; reads an Input class for some hard-coded input codes.
+/*
+Standard NES controller class; the buttons held are given to it by whatever frontend is in use (see getControllerButtons in
+input/input.h for the SDL one).
+
+The buttons only matter at the moments the game can see them: the 4021 takes them in while the latch is high, so they are copied
+into it when the latch is written (the game strobing $4016) and before each read while the latch is still high, and at no other
+time. A frontend running the NES on another thread changes the buttons through NES::queueButtons (see InputTimeline), so a game 
+polling mid-frame sees a change at the cycle it happened on, the same way on every run.
+*/
 class StandardController {
 public:
 	StandardController();
 	~StandardController();
 
-	// Reads in the input and sets input_values given that input.
-	void readInput(Input& input);
+	// Sets which buttons are held; see ControllerButtons for which bit is which button.
+	void setButtons(uint8_t buttons);
+	uint8_t getButtons() const;
 
-	// Updates the 4021 shift register w/ the internal input_values.
+	// Updates the 4021 shift register w/ the buttons held; only has an effect while the latch is high.
 	void update4021();
 
 	// Clocks the internal 4021 shift register; the serial input given to the 4021 is always 1.
 	void clock();
 
-	// Sets the latch (in the 4021) to the given value.
+	// Sets the latch (in the 4021) to the given value, taking in the buttons held at the moment it is written.
 	void setLatch(bool value);
+	bool getLatch() const;
 
 	bool getData() const;  // Gets the Q8 bit value.
+
+	// Gets/loads the 4021; this is part of the NES's state while input_values (what the player is holding) is not.
+	_4021 getShiftRegister() const;
+	void loadShiftRegister(const _4021& shiftRegister);
 private:
 	uint8_t input_values;  // Values indicating whether a button has been pressed, translated into a bitstring.
 	_4021 shift_register;  // Shift register; used to transfer and shift input data (as a bitstring) in a specific way.
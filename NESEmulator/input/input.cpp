@@ -1,4 +1,5 @@
 #include "input.h"
+#include "controller.h"
 #include <iostream>
 #include <iomanip>
 #include <string>
@@ -15,6 +16,10 @@ bool Input::updateInput() {
     // Some fault may lie in the laptop, as show by testing w/ an online keyboard rollover test, but that same test also reveals this function is still flawed somehow.
     
     this->staticKeyUpdate();  // First, do the update which will always happen.
+    this->keyEvents.clear();
+    // SDL timestamps its events in milliseconds since it started; how long ago each event was received is taken off the time now.
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const Uint32 ticks = SDL_GetTicks();
 	// Then see what the user has input.
     bool inputRecieved = false;
 	SDL_Event event;
@@ -22,12 +27,15 @@ bool Input::updateInput() {
         inputRecieved = true;
         switch (event.type) {
         case(SDL_KEYDOWN):
-            this->updateKeyState(event.key.keysym.scancode, true);
-
-            break;
-        case(SDL_KEYUP):
-            this->updateKeyState(event.key.keysym.scancode, false);
+        case(SDL_KEYUP): {
+            bool pressed = event.type == SDL_KEYDOWN;
+            this->updateKeyState(event.key.keysym.scancode, pressed);
+            if (!event.key.repeat) {
+                Uint32 age = event.key.timestamp <= ticks ? ticks - event.key.timestamp : 0;
+                this->keyEvents.push_back({ event.key.keysym.scancode, pressed, now - std::chrono::milliseconds(age) });
+            }
             break;
+        }
         case(SDL_QUIT):
             this->quit = true;
             break;
@@ -155,7 +163,40 @@ bool Input::getQuit() {
     return this->quit;
 }
 
+const std::vector<KeyEvent>& Input::getKeyEvents() const {
+    return this->keyEvents;
+}
+
 void Input::updateKeyState(SDL_Scancode key, bool pressed) {
     this->keyStates[key] = pressed && this->keyStates[key] != HELD ? PRESSED : this->keyStates[key];
     this->keyStates[key] = !pressed && this->keyStates[key] != NEUTRAL ? RELEASED : this->keyStates[key];
 }
+
+// Maps SDL_Scancodes to NES buttons stored as a byte w/ 1 bit toggled.
+static const std::map<SDL_Scancode, uint8_t> KEY_BUTTON_MAP = { { SDL_SCANCODE_RIGHT, ControllerButtons::RIGHT },
+																{ SDL_SCANCODE_LEFT,  ControllerButtons::LEFT },
+																{ SDL_SCANCODE_DOWN,  ControllerButtons::DOWN },
+																{ SDL_SCANCODE_UP,    ControllerButtons::UP },
+																{ SDL_SCANCODE_W,     ControllerButtons::START },
+																{ SDL_SCANCODE_Q,     ControllerButtons::SELECT },
+																{ SDL_SCANCODE_S,     ControllerButtons::B },
+																{ SDL_SCANCODE_A,     ControllerButtons::A } };
+
+uint8_t getControllerButtons(const Input& input) {
+	uint8_t buttons = 0x00;  // The ORed bits of the input according to the map.
+
+	// For every key being checked, if it is down or held, OR it with the byte indicating which keys are held.
+	for (auto const& [key, val] : KEY_BUTTON_MAP) {
+		KeyState key_state = input.getKeyState(key);
+		if (key_state == PRESSED || key_state == HELD) {
+			buttons |= val;
+		}
+	}
+
+	return buttons;
+}
+
+uint8_t getControllerButton(SDL_Scancode key) {
+	auto button = KEY_BUTTON_MAP.find(key);
+	return button != KEY_BUTTON_MAP.end() ? button->second : 0;
+}
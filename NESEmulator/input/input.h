@@ -1,6 +1,10 @@
 // input.h - An easier interface to use to get inputs that abstracts away from SDL. This is meant to be a singleton.
+#pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <vector>
 #include <SDL.h>
 
 // The first two key states are "static" states; they can be held in that state.
@@ -13,6 +17,13 @@ enum KeyState {
 	NA  // Not a valid keystate; used as a placeholder or similarly to NULL.
 };
 
+// A key going down or up, and when it did.
+struct KeyEvent {
+	SDL_Scancode key;
+	bool pressed;
+	std::chrono::steady_clock::time_point time;  // When SDL received it, which can be well before it was polled.
+};
+
 class Input {
 public:
 	Input();
@@ -39,8 +50,14 @@ public:
 	*/
 	bool getQuit();
 
+	/* const std::vector<KeyEvent>& getKeyEvents
+	The keys pressed and released during the last updateInput, oldest first; a held key repeating is left out.
+	*/
+	const std::vector<KeyEvent>& getKeyEvents() const;
+
 protected:
 	std::map<SDL_Scancode, KeyState> keyStates;
+	std::vector<KeyEvent> keyEvents;
 	bool quit;
 
 	/* void staticKeyUpdate
@@ -56,4 +73,15 @@ protected:
 	bool pressed - true means the key has been pressed, false means it has been released.
 	*/
 	void updateKeyState(SDL_Scancode key, bool pressed);
-};
\ No newline at end of file
+};
+
+/* uint8_t getControllerButtons
+Maps the keyboard to a standard controller; returns the buttons held in the format StandardController::setButtons takes.
+Arrow keys are the D-pad, W is Start, Q is Select, S is B, and A is A.
+*/
+uint8_t getControllerButtons(const Input& input);
+
+/* uint8_t getControllerButton
+Returns the button (see ControllerButtons) a key is mapped to by getControllerButtons, or 0 if it is not mapped to one.
+*/
+uint8_t getControllerButton(SDL_Scancode key);
@@ -14,6 +14,16 @@ void InputPort::deattachController() {
 	this->controller == nullptr;
 }
 
+void InputPort::setButtons(uint8_t buttons) {
+	if (this->controller == nullptr) return;
+	this->controller->setButtons(buttons);
+}
+
+uint8_t InputPort::getButtons() const {
+	if (this->controller == nullptr) return 0;
+	return this->controller->getButtons();
+}
+
 void InputPort::setLatch(bool val) {
 	if (this->controller == nullptr) return;  // Don't attempt to set the latch of a non-existent controller.
 	this->controller->setLatch(val);
@@ -21,9 +31,20 @@ void InputPort::setLatch(bool val) {
 
 uint8_t InputPort::readAndClock() {
 	if (this->controller == nullptr) return 0;  // Don't attempt to access a non-existent controller.
+	if (this->controller->getLatch()) this->controller->update4021();
 	uint8_t a = this->controller->getData();
 	uint8_t val = 1 ^ a;
 	this->controller->clock();
 	return val;
 }
 
+_4021 InputPort::getShiftRegister() const {
+	if (this->controller == nullptr) return _4021();
+	return this->controller->getShiftRegister();
+}
+
+void InputPort::loadShiftRegister(const _4021& shiftRegister) {
+	if (this->controller == nullptr) return;
+	this->controller->loadShiftRegister(shiftRegister);
+}
+
@@ -6,7 +6,7 @@ the controller and the NES's databus.
 
 #include <stdint.h>
 
-class StandardController;
+#include "controller.h"
 
 class InputPort {
 public:
@@ -17,12 +17,21 @@ public:
 	void attachController(StandardController* controller);
 	void deattachController();
 
+	// Sets/gets the buttons held on the attached controller, if any (none are held w/o one); see StandardController::setButtons.
+	void setButtons(uint8_t buttons);
+	uint8_t getButtons() const;
+
 	// Sets the latch value associated w/ the controller--- if any is attached.
 	void setLatch(bool val);
 
-	// Reads the input associated w/ the controller AND clocks it.
+	// Reads the input associated w/ the controller AND clocks it. While the latch is high the buttons are taken in first, as the 
+	// 4021 keeps taking them in for as long as the latch is high.
 	uint8_t readAndClock();
 
+	// Gets/loads the shift register of the attached controller; a default one is returned if no controller is attached.
+	_4021 getShiftRegister() const;
+	void loadShiftRegister(const _4021& shiftRegister);
+
 private:
 	StandardController* controller;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "inputTimeline.h"
+
+#include <algorithm>
+
+namespace {
+	// The machine cycles (PPU dots) in the shortest frame; using it keeps every change inside the frames it is meant for.
+	const unsigned long long MIN_CYCLES_PER_FRAME = 89341;
+	const size_t EVENTS_PER_READ = 32;
+}
+
+InputTimeline::InputTimeline(size_t capacity) :
+	events(capacity),
+	windowStart(),
+	started(false),
+	eventsScheduled(0),
+	eventsLate(0),
+	eventsDropped(0)
+{}
+InputTimeline::~InputTimeline() {}
+
+bool InputTimeline::push(uint8_t buttons, Clock::time_point time) {
+	InputEvent event;
+	event.time = time;
+	event.buttons = buttons;
+	if (this->events.write(&event, 1) == 0) {
+		this->eventsDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+void InputTimeline::scheduleFrames(NES& nes, unsigned int numFrames, Clock::time_point now) {
+	if (!this->started) {
+		this->flush(nes, now);  // Nothing to measure the first changes against.
+		return;
+	}
+
+	unsigned long long startCycle = nes.getTotalMachineCycles();
+	unsigned long long cycles = std::max(numFrames, 1u) * MIN_CYCLES_PER_FRAME;
+	double window = std::chrono::duration<double>(now - this->windowStart).count();
+
+	InputEvent read[EVENTS_PER_READ];
+	size_t count;
+	unsigned long long lastOffset = 0;
+	while ((count = this->events.read(read, EVENTS_PER_READ)) > 0) {
+		for (size_t i = 0; i < count; ++i) {
+			// How far through the window the change happened; one pushed after now was read goes at the very end.
+			double fraction = window > 0 ? std::chrono::duration<double>(read[i].time - this->windowStart).count() / window : 1.0;
+			if (fraction < 0) {
+				this->eventsLate.fetch_add(1, std::memory_order_relaxed);
+			}
+			unsigned long long offset = static_cast<unsigned long long>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(cycles - 1));
+			lastOffset = std::max(offset, lastOffset);  // The NES needs its changes in order, whatever order their times are in.
+			nes.queueButtons(startCycle + lastOffset, read[i].buttons);
+		}
+		this->eventsScheduled.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	this->windowStart = now;
+}
+
+void InputTimeline::flush(NES& nes, Clock::time_point now) {
+	InputEvent read[EVENTS_PER_READ];
+	size_t count;
+	while ((count = this->events.read(read, EVENTS_PER_READ)) > 0) {
+		for (size_t i = 0; i < count; ++i) {
+			nes.queueButtons(0, read[i].buttons);
+		}
+		this->eventsScheduled.fetch_add(count, std::memory_order_relaxed);
+	}
+	nes.flushQueuedButtons();
+
+	this->windowStart = now;
+	this->started = true;
+}
+
+InputTimelineStats InputTimeline::getStats() const {
+	InputTimelineStats stats;
+	stats.eventsScheduled = this->eventsScheduled.load(std::memory_order_relaxed);
+	stats.eventsLate = this->eventsLate.load(std::memory_order_relaxed);
+	stats.eventsDropped = this->eventsDropped.load(std::memory_order_relaxed);
+	return stats;
+}
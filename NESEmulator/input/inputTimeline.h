@@ -0,0 +1,68 @@
+// inputTimeline.h - Carries timestamped button changes from the input thread to the emulation thread and lands each on the machine cycle matching when it happened.
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "../globals/spscRingBuffer.hpp"
+#include "../NESEmulator.h"
+
+// A change in the buttons held on a controller (see ControllerButtons) and when it happened.
+struct InputEvent {
+	std::chrono::steady_clock::time_point time;
+	uint8_t buttons = 0;  // Every button held after the change, not just the one which changed.
+};
+
+// Counters to tell whether input is reaching the emulation on time.
+struct InputTimelineStats {
+	unsigned long long eventsScheduled = 0;
+	unsigned long long eventsLate = 0;  // Events which happened before the time already emulated; they land on the first cycle instead.
+	unsigned long long eventsDropped = 0;  // Events thrown away because the queue was full.
+};
+
+/*
+The emulation thread emulates each frame in a burst at the start of its time slot and then waits, so a button pressed while it waits
+would otherwise only be seen at whatever point of the next frame the game happens to read the controller, and how late that is
+depends on where in the slot the press fell. Instead, the input thread pushes every change w/ the time it happened, and each time
+the emulation thread is about to emulate some frames, scheduleFrames takes the changes since its last call and queues each on the
+NES (see NES::queueButtons) at the same fraction of the way through those frames as it happened between the two calls. In normal
+mode the calls are a frame apart, so a press lands at the same point in the next frame as it happened in the frame being shown:
+a constant frame behind rather than anywhere from none to a frame, and the game sees presses and releases as far apart as they
+really were, even several within a frame. When fast-forwarding or catching up, the changes are spread over all the frames emulated.
+
+Exactly one thread may push and exactly one thread may schedule; the queue never blocks either of them.
+*/
+class InputTimeline {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	InputTimeline(size_t capacity = 256);
+	~InputTimeline();
+
+	// --- Input thread --- //
+
+	// Queues a change; returns false (and counts it as dropped) if the queue is full.
+	bool push(uint8_t buttons, Clock::time_point time = Clock::now());
+
+	// --- Emulation thread --- //
+
+	// Queues the changes pushed since the last call on the NES over the next numFrames frames; see above.
+	void scheduleFrames(NES& nes, unsigned int numFrames, Clock::time_point now = Clock::now());
+	// Makes every change pushed so far happen now (e.g. while rewinding, when the emulated time does not follow the clock),
+	// and starts the timeline over from now.
+	void flush(NES& nes, Clock::time_point now = Clock::now());
+
+	// --- Either thread --- //
+
+	InputTimelineStats getStats() const;
+
+private:
+	SPSCRingBuffer<InputEvent> events;
+
+	Clock::time_point windowStart;  // Emulation thread only. When scheduleFrames or flush was last called.
+	bool started;  // Emulation thread only. Whether windowStart has been set.
+
+	std::atomic<unsigned long long> eventsScheduled;
+	std::atomic<unsigned long long> eventsLate;
+	std::atomic<unsigned long long> eventsDropped;
+};
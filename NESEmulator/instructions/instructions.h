@@ -7,7 +7,7 @@
 #include <cstdint>
 #include "../databus/databus.h"
 
-enum AddressingModes;
+enum AddressingModes : int;
 class Registers;
 
 typedef void(*RegOp)(Registers& registers, uint8_t data);  // Operations which work with data and the registers.
@@ -45,7 +45,7 @@ union AddressingOperation {
 };
 
 
-enum AddressingModes {
+enum AddressingModes : int {
 	IMPLICIT,
 	ACCUMULATOR,
 	IMMEDIATE,
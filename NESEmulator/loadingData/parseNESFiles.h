@@ -3,6 +3,7 @@
 
 #include "../memory/memory.h"
 #include <stdint.h>
+#include <memory>
 #include <vector>
 #include <fstream>
 #include <iostream>
@@ -36,13 +37,11 @@ struct NESFileData {
 
 	std::vector<uint8_t> programData;
 	std::vector<uint8_t> characterData;
-	Memory* CHRDATA;  // NOTE: I am putting the CHRDATA here because NES cartridges store their CHRDATA on the cartridge.
+	std::shared_ptr<Memory> CHRDATA;  // NOTE: I am putting the CHRDATA here because NES cartridges store their CHRDATA on the cartridge.
 	// I do not know if doing this code-wise is the best approach, but I am doing it for now to see how it goes.
 	// Alternatively, I coould create a pointer to CHRDATA in NESEmulator.
 
-	NESFileData() : CHRDATA(nullptr) {
-		this->CHRDATA = new Memory(0x2000);  // TODO: Implement bank-switching for CHRDATA.
-	};
+	NESFileData() : CHRDATA(std::make_shared<Memory>(0x2000)) {};  // TODO: Implement bank-switching for CHRDATA.
 	~NESFileData() {};
 
 	// Checks if the size of the program and character data correspond to the program and character size indicated in the header.
@@ -12,6 +12,10 @@
 #include "ppu/ppu.h"
 
 #include "graphics/graphics.h"
+#include "graphics/sdlDisplay.h"
+#include "graphics/indexedFrameBuffer.h"
+#include "graphics/scaler.h"
+#include "graphics/ntscFilter.h"
 #include "graphics/textRenderer.hpp"
 
 
@@ -22,6 +26,23 @@
 #include "debuggingTools/debugInput.h"
 
 #include "input/controller.h"
+#include "input/inputTimeline.h"
+#include "savestates/rewindBuffer.h"
+#include "runAhead/runAhead.h"
+#include "timing/speedControl.h"
+#include "recording/frameSink.h"
+#include "recording/audioSink.h"
+#include "recording/movie.h"
+#include "audio/audioStream.h"
+
+#include "globals/tripleBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
 
 #undef main  // Deals w/ the definition of main in SDL.
 int main() { 
@@ -41,7 +62,7 @@ int main() {
 	bool quit = false;
 	unsigned long long frameCounter = 0;
 
-	Memory VRAM{ 0x800 };
+	VideoRAM VRAM;
 	PPUDebug ppu;
 	NESDatabus databus;
 	RAM ram;
@@ -66,11 +87,11 @@ int main() {
 		}
 
 		input.updateInput();
-		controller.readInput(input);  // Update the controller every frame.
+		controller.setButtons(getControllerButtons(input));  // Update the controller every frame.
 		quit = input.getQuit();
 
 		controller.setLatch(true);
-		controller.readInput(input);
+		controller.setButtons(getControllerButtons(input));
 		controller.setLatch(false);
 
 		if (frameCounter % 60 == 0) {
@@ -90,7 +111,7 @@ int main() {
 	
 	*/
 	
-	Memory VRAM{ 0x800 };
+	VideoRAM VRAM;
 	PPUDebug ppu;
 	NESDatabus databus;
 	RAM ram;
@@ -116,12 +137,37 @@ int main() {
 	CommandlineInput CLI;
 	
 	SDL_Init(SDL_INIT_EVERYTHING);
-	Graphics graphics{514, 256};
-	ppu.attachGraphics(&graphics);
+	// The window shows a 514x256 canvas: the NES's picture on the left and an overlay w/ the speed to the right of it.
+	const int CANVAS_W = 514, CANVAS_H = 256;
+	Graphics overlay{ CANVAS_W - DISPLAY_WIDTH, 60 };
+
+	// A frame handed from the emulation thread to this one, along w/ how fast it was emulated.
+	struct EmulatedFrame {
+		IndexedFrameBuffer picture;
+		SpeedMode::SpeedMode speedMode = SpeedMode::NORMAL;
+		SpeedStats speedStats;
+	};
+	TripleBuffer<EmulatedFrame> frames;
+	ppu.attachFrameBuffer(&frames.getWriteBuffer().picture);
 
 	SDL_Window* window = SDL_CreateWindow("My Window", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 1024, 480, SDL_WINDOW_RESIZABLE);
-	SDL_Renderer* renderer = SDL_CreateRenderer(window, 0, 0);
-	SDL_Surface* windowSurface = SDL_GetWindowSurface(window);
+	TexturePresenter presenter{ window, CANVAS_W, CANVAS_H, true };  // Waiting for vsync only holds up this thread, not the emulation.
+	if (!presenter.isAccelerated()) {
+		std::cout << "No accelerated renderer is available; using the software renderer." << std::endl;
+	}
+
+	// The pixel-art filter applied to frames before they are shown, if any (cycled through w/ G).
+	const unsigned int SCALE2X_FACTORS[] = { 0, 2, 4 };  // 0 = unfiltered.
+	unsigned int scaleOption = 0;
+	FrameScaler scaler{ ScaleFilter::SCALE2X, 2 };
+	std::vector<uint32_t> rgbaFrame(DISPLAY_WIDTH * DISPLAY_HEIGHT);  // The frame converted to RGBA for the scaler.
+	// The scaler's last output and the frame it is of (nullptr if there is none); static screens are only scaled once.
+	const uint32_t* scaled = nullptr;
+	uint64_t scaledFrameHash = 0;
+
+	// The NTSC filter (toggled w/ N) runs on its own thread; it is only started once it is first turned on. Takes priority over Scale2x.
+	std::unique_ptr<NTSCFilterThread> ntscFilter;
+	bool ntscEnabled = false;
 
 	//graphics.lockDisplay();
 	bool patternTable = false;
@@ -131,19 +177,237 @@ int main() {
 	//graphics.unlockDisplay();
 
 	bool quit = false;
+	uint8_t heldButtons = 0;  // The buttons as of the last change pushed to inputTimeline.
 
 	int numFrames = 1;
 	int numElapsed = 0;
 	unsigned long long total_frames = 0;
-	FrameCounter frame_counter;
+
+	RewindBuffer rewindBuffer;
+	NESState rewindState;
+
+	RunAhead runAhead{ nes, 1 };
+	const SDL_Scancode RUN_AHEAD_KEYS[] = { SDL_SCANCODE_0, SDL_SCANCODE_1, SDL_SCANCODE_2, SDL_SCANCODE_3 };
+
+	SpeedControl speedControl;
+
+	// The audio device pulls samples from audioStream on its own thread (see AudioStream); the NES makes them at the device's rate.
+	std::unique_ptr<AudioStream> audioStream;
+	SDL_AudioSpec desiredAudio{}, audioSpec{};
+	desiredAudio.freq = 48000;
+	desiredAudio.format = AUDIO_S16SYS;
+	desiredAudio.channels = 1;
+	desiredAudio.samples = 512;
+	desiredAudio.userdata = &audioStream;  // The device starts paused, so the stream is made before the callback ever runs.
+	desiredAudio.callback = [](void* userdata, Uint8* stream, int length) {
+		(*static_cast<std::unique_ptr<AudioStream>*>(userdata))->read(reinterpret_cast<int16_t*>(stream), length / sizeof(int16_t));
+	};
+	SDL_AudioDeviceID audioDevice = SDL_OpenAudioDevice(nullptr, 0, &desiredAudio, &audioSpec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+	if (audioDevice == 0) {
+		std::cout << "Could not open an audio device (" << SDL_GetError() << "); running w/o sound." << std::endl;
+	} else {
+		// Aims to keep the device's buffer plus 2 frames queued, which is enough to ride out a late frame.
+		size_t targetFill = audioSpec.samples + static_cast<size_t>(2 * audioSpec.freq / NTSC_FRAME_RATE);
+		audioStream = std::make_unique<AudioStream>(targetFill, targetFill * 4);
+		nes.setAudioSampleRate(audioSpec.freq);
+		SDL_PauseAudioDevice(audioDevice, 0);
+	}
+	const unsigned int audioSampleRate = audioDevice != 0 ? audioSpec.freq : 48000;
+	std::vector<int16_t> frameSamples;  // The samples of the frames just emulated; emulation thread only.
+
+	// What the user asked for; written by this thread and read by the emulation thread.
+	std::atomic<bool> emulating{ true };
+	std::atomic<bool> rewinding{ false };
+	std::atomic<bool> turbo{ false };
+	std::atomic<unsigned int> turboInterval{ speedControl.getTurboInterval() };
+	std::atomic<int> requestedFramesAhead{ -1 };  // -1 when there is no new request.
+	std::atomic<bool> recording{ false };
+	std::atomic<bool> recordingMovie{ false };
+	std::atomic<bool> playingMovie{ false };
+	std::atomic<int> movieSeek{ 0 };  // Frames to seek forward (or back, if negative) in the movie being played.
+	InputTimeline inputTimeline;  // The changes to the buttons held, w/ when they happened (see InputTimeline).
+
+	// Records every frame shown to recording.y4m and all the audio to recording.wav while recording is on (toggled w/ V); owned by
+	// the emulation thread.
+	std::unique_ptr<FrameSink> recorder;
+	std::unique_ptr<AudioSink> audioRecorder;
+
+	// Records the buttons held each frame to movie.nesm (toggled w/ M), or plays that movie back in place of the keyboard (toggled
+	// w/ P); owned by the emulation thread. Rewinding stops either, since the movie would no longer match what was emulated.
+	const char* MOVIE_PATH = "movie.nesm";
+	const int MOVIE_SEEK_FRAMES = 600;  // How far [ and ] seek, about 10 seconds.
+	std::unique_ptr<MovieRecorder> movieRecorder;
+	std::unique_ptr<MoviePlayer> moviePlayer;
+
+	/* The NES runs on its own thread at the pace SpeedControl sets, and each frame it finishes is published to this thread, which
+	presents the newest one. Neither waits on the other, so a slow window system never holds up the emulation. Everything the
+	emulation thread uses (the NES, rewind, run-ahead and speed control) is only touched by it until it is joined. */
+	std::thread emulationThread([&]() {
+		while (emulating.load(std::memory_order_relaxed)) {
+			speedControl.setMode(turbo ? SpeedMode::TURBO : SpeedMode::NORMAL);
+			speedControl.setTurboInterval(turboInterval);
+
+			int framesAhead = requestedFramesAhead.exchange(-1);
+			if (framesAhead >= 0) {
+				const RunAheadStats& stats = runAhead.getStats();
+				std::cout << "Run-ahead of " << runAhead.getFramesAhead() << " frame(s) over " << stats.framesPresented << " frames: "
+						  << stats.getAverageFrameMS() << "ms/frame + " << stats.getAverageOverheadMS() << "ms run-ahead (max " << stats.maxOverheadMS << "ms, "
+						  << stats.getOverheadRatio() * 100 << "% overhead), ~" << runAhead.getLatencySavedMS() << "ms of lag removed.\n";
+				std::cout << "Now running " << framesAhead << " frame(s) ahead." << std::endl;
+				runAhead.setFramesAhead(framesAhead);
+				runAhead.resetStats();
+			}
+
+			if (rewinding) {
+				recordingMovie = false;
+				playingMovie = false;
+			}
+			if (recordingMovie && !movieRecorder) {
+				movieRecorder = std::make_unique<MovieRecorder>(MOVIE_PATH);
+				if (movieRecorder->isOpen()) {
+					std::cout << "Recording a movie to " << MOVIE_PATH << "." << std::endl;
+				} else {
+					std::cout << "Could not open " << MOVIE_PATH << "." << std::endl;
+					movieRecorder.reset();
+					recordingMovie = false;
+				}
+			} else if (!recordingMovie && movieRecorder) {
+				std::cout << "Movie recording stopped after " << movieRecorder->getFrameCount() << " frames." << std::endl;
+				movieRecorder.reset();
+			}
+			if (playingMovie && !moviePlayer) {
+				moviePlayer = std::make_unique<MoviePlayer>();
+				MovieResult::MovieResult result = moviePlayer->open(MOVIE_PATH);
+				if (result == MovieResult::SUCCESS) {
+					result = moviePlayer->seek(nes, 0);
+				}
+				if (result == MovieResult::SUCCESS) {
+					std::cout << "Playing " << MOVIE_PATH << " (" << moviePlayer->getFrameCount() << " frames)." << std::endl;
+				} else {
+					std::cout << "Could not play " << MOVIE_PATH << " (error " << result << ")." << std::endl;
+					moviePlayer.reset();
+					playingMovie = false;
+				}
+			} else if (!playingMovie && moviePlayer) {
+				moviePlayer.reset();
+				std::cout << "Movie playback stopped." << std::endl;
+			}
+			int seekFrames = movieSeek.exchange(0);
+			if (moviePlayer && seekFrames != 0) {
+				long long target = std::max(static_cast<long long>(moviePlayer->getFrame()) + seekFrames, 0ll);
+				moviePlayer->seek(nes, static_cast<unsigned long long>(target));  // SpeedControl drops the time this takes like any long frame.
+			}
+
+			// The buttons for each real frame: while a movie is played they come from it, and while one is recorded they are only
+			// changed between frames so each frame's buttons are all there is to record.
+			auto beginFrame = [&]() {
+				if (moviePlayer) {
+					if (!moviePlayer->playFrame(nes)) {
+						std::cout << "Movie finished." << std::endl;
+						moviePlayer.reset();
+						playingMovie = false;
+					} else if (moviePlayer->getFirstDesync() >= 0 && moviePlayer->getFrame() == static_cast<unsigned long long>(moviePlayer->getFirstDesync()) + 1) {
+						std::cout << "The movie no longer matches the emulation as of frame " << moviePlayer->getFirstDesync() << "." << std::endl;
+					}
+				}
+				if (movieRecorder) {
+					movieRecorder->recordFrame(nes, controller.getButtons());
+				}
+			};
+
+			// The frames skipped (when fast-forwarding or catching up) are emulated w/o being drawn, then one more frame is drawn.
+			unsigned int framesToSkip = speedControl.beginFrame();
+
+			// While rewinding, a snapshot is popped for every frame which would have been emulated and the frame after the last one is 
+			// run again so it gets drawn; otherwise the state at the start of every frame is saved.
+			if (rewinding) {
+				inputTimeline.flush(nes);
+				bool popped = false;
+				for (unsigned int i = 0; i <= framesToSkip; ++i) {
+					popped |= rewindBuffer.pop(rewindState);
+				}
+				if (popped) {
+					nes.loadState(rewindState);
+				}
+			} else {
+				if (moviePlayer || movieRecorder) {
+					inputTimeline.flush(nes);
+				} else {
+					inputTimeline.scheduleFrames(nes, framesToSkip + 1);
+				}
+				nes.setVideoOutput(false);
+				// Checks for quitting too, so exiting never waits on a long run of skipped frames.
+				for (unsigned int i = 0; i < framesToSkip && emulating.load(std::memory_order_relaxed); ++i) {
+					nes.getState(rewindState);
+					rewindBuffer.push(rewindState);
+					beginFrame();
+					nes.executeFrame();
+				}
+				nes.getState(rewindState);
+				rewindBuffer.push(rewindState);
+				beginFrame();
+			}
+
+			runAhead.executeFrame();
+
+			// The samples of every frame emulated since the last one, skipped frames included; while fast-forwarding or rewinding
+			// they would only be noise, so the audio is paused instead.
+			frameSamples.resize(nes.getAudioSamplesAvailable());
+			frameSamples.resize(nes.readAudioSamples(frameSamples.data(), frameSamples.size()));
+			if (audioStream) {
+				if (speedControl.getMode() == SpeedMode::NORMAL && !rewinding) {
+					audioStream->write(frameSamples.data(), frameSamples.size());
+				} else {
+					audioStream->pause();
+				}
+				nes.setAudioRateAdjustment(audioStream->getRateAdjustment());
+			}
+
+			if (recording && !recorder) {
+				recorder = std::make_unique<FrameSink>(FrameFormat::Y4M, "recording.y4m", ppu.getPaletteLUT());
+				audioRecorder = std::make_unique<AudioSink>(AudioFormat::WAV, "recording.wav", audioSampleRate);
+				if (recorder->isOpen() && audioRecorder->isOpen()) {
+					std::cout << "Recording to recording.y4m and recording.wav." << std::endl;
+				} else {
+					std::cout << "Could not open recording.y4m or recording.wav." << std::endl;
+					recorder.reset();
+					audioRecorder.reset();
+					recording = false;
+				}
+			} else if (!recording && recorder) {
+				recorder.reset();  // Finishes writing the queued frames.
+				audioRecorder.reset();
+				std::cout << "Recording stopped." << std::endl;
+			}
+			if (recorder && !recorder->submit(frames.getWriteBuffer().picture)) {
+				std::cout << "Recording fell behind; " << recorder->getStats().framesDropped << " frame(s) dropped so far." << std::endl;
+			}
+			if (audioRecorder) {
+				audioRecorder->submitFrame(frameSamples.data(), frameSamples.size());
+			}
+
+			EmulatedFrame& frame = frames.getWriteBuffer();
+			frame.speedMode = speedControl.getMode();
+			frame.speedStats = speedControl.getStats();
+			frames.publish();
+
+			// The next frame is drawn over a copy of this one, so an older picture never shows through where a frame is left undrawn 
+			// (e.g. while the game has rendering disabled).
+			frames.getWriteBuffer().picture = frames.getPublished().picture;
+			ppu.attachFrameBuffer(&frames.getWriteBuffer().picture);
+
+			speedControl.endFrame();
+		}
+	});
+
 	std::cout << "Standard NES controller used; arrow keys correspond to the directions on the D-pad. Other controls:\n" <<
-				 "W - Start\nQ - Select\nS - B Button\nA - A Button" << std::endl;
+				 "W - Start\nQ - Select\nS - B Button\nA - A Button\nR - Rewind (hold)\n" <<
+				 "0-3 - Set the number of frames to run ahead (prints the run-ahead stats so far)\n" <<
+				 "F - Toggle fast-forward\n- and = - Show fewer or more frames while fast-forwarding\n" <<
+				 "G - Cycle through the Scale2x filter (off, 2x, 4x)\nN - Toggle the NTSC filter\nV - Start/stop recording to recording.y4m and recording.wav\n" <<
+				 "M - Start/stop recording a movie of the buttons pressed to movie.nesm\nP - Start/stop playing movie.nesm\n[ and ] - Seek 10 seconds back or forward in the movie" << std::endl;
 	while (!quit) {
 		++total_frames;
-		for (int i = 0; i < 357954; ++++i) {
-			controller.update4021();  // Transfers inputs to 4021 every clock cycle.
-			nes.executeMachineCycle();
-		}
 
 		input.updateInput();
 		/*
@@ -159,10 +423,109 @@ int main() {
 		*/
 
 		quit = input.getQuit();
-		controller.readInput(input);  // Reads an input every frame
+		// Each change to the buttons is handed to the emulation thread w/ when the key went down or up, so it lands on the matching 
+		// cycle rather than at the start of the next frame. The key states are checked afterwards in case SDL dropped an event.
+		for (const KeyEvent& event : input.getKeyEvents()) {
+			uint8_t button = getControllerButton(event.key);
+			uint8_t newButtons = event.pressed ? heldButtons | button : heldButtons & ~button;
+			if (newButtons != heldButtons) {
+				heldButtons = newButtons;
+				inputTimeline.push(heldButtons, event.time);
+			}
+		}
+		if (getControllerButtons(input) != heldButtons) {
+			heldButtons = getControllerButtons(input);
+			inputTimeline.push(heldButtons);
+		}
+		KeyState rewindKey = input.getKeyState(SDL_SCANCODE_R);
+		rewinding = rewindKey == HELD || rewindKey == PRESSED;
+
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (input.getKeyState(RUN_AHEAD_KEYS[i]) == PRESSED) {
+				requestedFramesAhead = i;
+			}
+		}
+
+		if (input.getKeyState(SDL_SCANCODE_G) == PRESSED) {
+			scaleOption = (scaleOption + 1) % 3;
+			scaler.setFilter(ScaleFilter::SCALE2X, SCALE2X_FACTORS[scaleOption]);
+			scaled = nullptr;
+		}
+		if (input.getKeyState(SDL_SCANCODE_N) == PRESSED) {
+			ntscEnabled = !ntscEnabled;
+			if (ntscEnabled && !ntscFilter) {
+				ntscFilter = std::make_unique<NTSCFilterThread>();
+			}
+		}
+		if (input.getKeyState(SDL_SCANCODE_V) == PRESSED) {
+			recording = !recording;
+		}
+		if (input.getKeyState(SDL_SCANCODE_M) == PRESSED) {
+			playingMovie = false;
+			recordingMovie = !recordingMovie;
+		}
+		if (input.getKeyState(SDL_SCANCODE_P) == PRESSED) {
+			recordingMovie = false;
+			playingMovie = !playingMovie;
+		}
+		if (input.getKeyState(SDL_SCANCODE_LEFTBRACKET) == PRESSED) {
+			movieSeek -= MOVIE_SEEK_FRAMES;
+		}
+		if (input.getKeyState(SDL_SCANCODE_RIGHTBRACKET) == PRESSED) {
+			movieSeek += MOVIE_SEEK_FRAMES;
+		}
+		if (input.getKeyState(SDL_SCANCODE_F) == PRESSED) {
+			turbo = !turbo;
+		}
+		if (input.getKeyState(SDL_SCANCODE_EQUALS) == PRESSED) {
+			turboInterval = std::min(turboInterval * 2, MAX_TURBO_INTERVAL);
+		}
+		if (input.getKeyState(SDL_SCANCODE_MINUS) == PRESSED) {
+			turboInterval = std::max(turboInterval / 2, 1u);
+		}
+
+		// Nothing to present until the emulation thread finishes another frame; wait a little rather than spin.
+		if (!frames.update()) {
+			SDL_Delay(1);
+			continue;
+		}
+		const EmulatedFrame& frame = frames.getReadBuffer();
 		
-		graphics.blitDisplay(windowSurface);
-		SDL_UpdateWindowSurface(window);
+		// The frame is only converted to RGBA now that it is shown.
+		const Rect pictureRect{ 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT };
+		if (ntscEnabled) {
+			// The filtered frame shown lags the newest one by however long the filter thread takes.
+			ntscFilter->submit(frame.picture);
+			ntscFilter->update();
+			presenter.drawPixels(ntscFilter->getOutput(), NTSC_OUTPUT_WIDTH, DISPLAY_HEIGHT, NTSC_OUTPUT_WIDTH, pictureRect);
+		} else if (SCALE2X_FACTORS[scaleOption] == 0) {
+			presenter.drawFrame(frame.picture, ppu.getPaletteLUT(), pictureRect);
+		} else {
+			if (scaled == nullptr || scaledFrameHash != frame.picture.getFrameHash()) {
+				frame.picture.convertToRGBA(ppu.getPaletteLUT(), rgbaFrame.data(), DISPLAY_WIDTH);
+				scaled = scaler.scale(rgbaFrame.data(), DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_WIDTH);
+				scaledFrameHash = frame.picture.getFrameHash();
+			}
+			presenter.drawPixels(scaled, scaler.getOutputWidth(), scaler.getOutputHeight(), scaler.getOutputWidth(), pictureRect);
+		}
+
+		// The speed and frame times (in ms) are shown to the right of the picture.
+		std::ostringstream speedText, skippedText, frameTimeText, audioText;
+		speedText << (frame.speedMode == SpeedMode::TURBO ? "TURBO " : "SPEED ") << std::fixed << std::setprecision(2) << frame.speedStats.speedMultiplier << "X";
+		skippedText << "SKIPPED " << frame.speedStats.framesSkipped;
+		frameTimeText << std::fixed << std::setprecision(2) << "P50 " << frame.speedStats.frameTimeP50 << " P99 " << frame.speedStats.frameTimeP99;
+		overlay.clear(0x000000ff);
+		renderText(overlay, speedText.str(), 8, 4);
+		renderText(overlay, skippedText.str(), 8, 16);
+		renderText(overlay, frameTimeText.str(), 8, 28);
+		if (audioStream) {  // The samples queued for the audio device, and how often it ran dry (U) or the queue was full (O).
+			AudioStreamStats audioStats = audioStream->getStats();
+			audioText << "AUDIO " << audioStats.bufferFill << " U " << audioStats.underruns << " O " << audioStats.overruns;
+			renderText(overlay, audioText.str(), 8, 40);
+		}
+		presenter.drawGraphics(overlay, Rect{ DISPLAY_WIDTH, 0, overlay.w, overlay.h });
+
+		presenter.present();
 		/*
 		if (numElapsed >= numFrames) {
 			numFrames = CLI.getUserInt("Elapse how many more frames? ");
@@ -173,10 +536,14 @@ int main() {
 			input.printKeyStates();
 		}*/
 		++numElapsed;	
-		SDL_Delay(1000.0 / 60.0);
-		frame_counter.countFrame();
 	}
 
+	emulating = false;
+	emulationThread.join();
+
+	if (audioDevice != 0) {
+		SDL_CloseAudioDevice(audioDevice);
+	}
 	SDL_Quit();
 	
 	
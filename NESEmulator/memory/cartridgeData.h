@@ -5,6 +5,12 @@
 
 constexpr int SIZE_OF_CARTRIDGE = 0xBFE0;
 
+// The parts of a cartridge a game can write to, which are kept in NESState: PRG RAM (often battery-backed) and CHRDATA, which is
+// RAM on carts w/o CHR ROM. CHRDATA holds both pattern tables.
+constexpr uint16_t PRG_RAM_START = 0x6000;
+constexpr size_t PRG_RAM_SIZE = 0x2000;
+constexpr size_t CHRDATA_SIZE = 0x2000;
+
 class Mapper_0 : public Memory {
 public:
 	Mapper_0();
@@ -0,0 +1,65 @@
+// fixedMemory.hpp - A memory module whose size is known at compile time and whose bytes are stored inline.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string>
+#include <sstream>
+
+/*
+Fixed-size counterpart to Memory; used for the NES's internal memories (RAM, VRAM, OAM, palette RAM, etc.)
+whose sizes never change. The bytes live directly inside the object (and hence inside whatever owns it), so
+there is no heap indirection, and since the size is a power of two every address is simply masked instead of
+being checked against or divided by the size.
+
+NOTE: Addresses past the end wrap around (i.e. they are mirrored), which is how the NES treats these memories anyways
+since it never decodes the upper address lines.
+
+NOTE: This intentionally is not a child of Memory; calls to it are non-virtual so that they can be inlined.
+*/
+template <size_t N>
+class FixedMemory {
+	static_assert(N != 0 && (N & (N - 1)) == 0, "The size of a FixedMemory module must be a power of two.");
+public:
+	static constexpr uint16_t ADDRESS_MASK = static_cast<uint16_t>(N - 1);
+
+	FixedMemory() : data{} {}
+
+	uint8_t getByte(uint16_t address) const {
+		return this->data[address & ADDRESS_MASK];
+	}
+	// Returns the old value at the given address.
+	uint8_t setByte(uint16_t address, uint8_t value) {
+		uint8_t& byte = this->data[address & ADDRESS_MASK];
+		uint8_t oldValue = byte;
+		byte = value;
+		return oldValue;
+	}
+
+	static constexpr size_t size() {
+		return N;
+	}
+
+	// Direct access to the underlying bytes.
+	uint8_t* getData() {
+		return this->data.data();
+	}
+	const uint8_t* getData() const {
+		return this->data.data();
+	}
+
+	// Gets the data contained in this memory module as a space-seperated string; same format as Memory::getDataAsStr.
+	std::string getDataAsStr() const {
+		std::stringstream serialStr;
+		serialStr << (int)this->data[0];
+		for (size_t i = 1; i < N; ++i) {
+			serialStr << " " << (int)this->data[i];
+		}
+
+		return serialStr.str();
+	}
+
+private:
+	std::array<uint8_t, N> data;
+};
@@ -1,59 +1,108 @@
 #include "memory.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <sstream>
 
 Memory::Memory() : Memory(0) {}
-Memory::Memory(unsigned int size) {
-	for (unsigned int i = 0; i < size; ++i) {
-		this->data.push_back(0);
-	}
-}
+Memory::Memory(unsigned int size) : data(std::make_shared<std::vector<uint8_t>>(size, 0)) {}
 Memory::~Memory() {}
 
 uint8_t Memory::getByte(uint16_t address) const {
-	if (address >= this->data.size()) {  // Check if we are indexing the memory in a valid way.
+	const std::vector<uint8_t>& data = *this->data;
+	if (address >= data.size()) {  // Check if we are indexing the memory in a valid way.
 		return 0;
 	}
-	return this->data.at(address);
+	return data[address];
+}
+
+void Memory::getBytes(uint16_t address, uint8_t* out, size_t count) const {
+	const std::vector<uint8_t>& data = *this->data;
+	size_t inRange = address < data.size() ? std::min(count, data.size() - address) : 0;  // Bytes past the end read as 0.
+	if (inRange > 0) {
+		std::memcpy(out, data.data() + address, inRange);
+	}
+	std::fill(out + inRange, out + count, static_cast<uint8_t>(0));
+}
+
+void Memory::setBytes(uint16_t address, const uint8_t* in, size_t count) {
+	size_t inRange = address < this->data->size() ? std::min(count, this->data->size() - address) : 0;
+	if (inRange == 0 || std::memcmp(this->data->data() + address, in, inRange) == 0) {
+		return;
+	}
+	this->unshare();
+	std::memcpy(this->data->data() + address, in, inRange);
 }
 
 Memory& Memory::operator=(const Memory& memory) {
+	if (this == &memory) {
+		return *this;
+	}
+	this->unshare();
+	std::vector<uint8_t>& data = *this->data;
+	const std::vector<uint8_t>& otherData = *memory.data;
+
 	// Copy only as many bytes as we can store UNLESS our size is 0; in which case, increase the size of this
 	// module to account for that.
 	size_t bytesToCopy;
-	if (this->data.size()) {
-		bytesToCopy = this->data.size() > memory.data.size() ? memory.data.size() : this->data.size();
+	if (data.size()) {
+		bytesToCopy = data.size() > otherData.size() ? otherData.size() : data.size();
 	} else {
-		bytesToCopy = memory.data.size();
+		bytesToCopy = otherData.size();
 		for (int i = 0; i < bytesToCopy; ++i) {
-			this->data.push_back(0);
+			data.push_back(0);
 		}
 	}
 
 	for (int i = 0; i < bytesToCopy; ++i) {
-		this->data.at(i) = memory.data.at(i);
+		data.at(i) = otherData.at(i);
 	}
 
 	return *this;
 }
 
 std::string Memory::getDataAsStr() const {
+	const std::vector<uint8_t>& data = *this->data;
 	std::stringstream serialStr;
 	// We will iterate through the data, appending it to the string as we go along.
-	if (this->data.size() == 0) return serialStr.str();  // Edge case: if we have no data, then return an empty string.
+	if (data.size() == 0) return serialStr.str();  // Edge case: if we have no data, then return an empty string.
 	
 	// Append the first byte w/o a comma since it is the first element. 
-	serialStr << (int)this->data.at(0);
-	for (int i = 1; i < this->data.size(); ++i) {
-		serialStr << " " << (int)this->data.at(i);
+	serialStr << (int)data.at(0);
+	for (int i = 1; i < data.size(); ++i) {
+		serialStr << " " << (int)data.at(i);
 	}
 
 	return serialStr.str();
 }
 
+std::shared_ptr<const std::vector<uint8_t>> Memory::share() const {
+	return this->data;
+}
+
+void Memory::restore(const std::shared_ptr<const std::vector<uint8_t>>& data) {
+	// NOTE: The data is never written through while another module (or snapshot) shares it, so casting away const is safe.
+	this->data = std::const_pointer_cast<std::vector<uint8_t>>(data);
+}
+
+void Memory::unshare() {
+	if (this->data.use_count() != 1) {
+		this->data = std::make_shared<std::vector<uint8_t>>(*this->data);
+	}
+	// Whoever shared the data last may have read it on another thread right before letting go of it; this makes sure those reads
+	// happen before our writes (releasing a shared_ptr is a release operation, but use_count is only a relaxed read).
+	std::atomic_thread_fence(std::memory_order_acquire);
+}
+
 uint8_t Memory::setByte(uint16_t address, uint8_t value) {
-	// NOTE: experimenting with just using the modulo of the address.
-	address %= this->data.size();
-	uint8_t oldValue = this->data.at(address);
-	this->data.at(address) = value;
+	this->unshare();
+	std::vector<uint8_t>& data = *this->data;
+	// NOTE: experimenting with just using the modulo of the address; only done when actually out of range since it is a division.
+	if (address >= data.size()) {
+		if (data.size() == 0) return 0;
+		address %= data.size();
+	}
+	uint8_t oldValue = data[address];
+	data[address] = value;
 	return oldValue;
 }
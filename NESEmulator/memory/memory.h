@@ -11,7 +11,8 @@ constexpr int BYTES_OF_MEMORY = 0x10000;
 /*
 Basic memory class. Right now it is no different from just an array,
 but I may use it as a parent class for future memory modules when I 
-implement paging, etc.
+implement paging, etc. Memory whose size is fixed (RAM, VRAM, OAM, etc.)
+should use FixedMemory (see fixedMemory.hpp) instead.
 
 I will also implement the quirks of memory addressing on the NES either
 here or the databus, depending on its exact functionality.
@@ -24,12 +25,25 @@ public:
 
 	virtual uint8_t getByte(uint16_t address) const;
 	virtual uint8_t setByte(uint16_t address, uint8_t value);  // Returns the old value at the given address.
+	// Copies count bytes starting at address into out; the same as count calls to getByte. 
+	// NOTE: Children which override getByte must override this as well.
+	virtual void getBytes(uint16_t address, uint8_t* out, size_t count) const;
+	// Copies count bytes from in to address on; bytes past the end are dropped. If the bytes are already the same nothing is 
+	// written, so shared data (see share) stays shared. NOTE: Children which override setByte must override this as well.
+	virtual void setBytes(uint16_t address, const uint8_t* in, size_t count);
     // Copies the data from one memory module to another as much as it can (limit is module w/ fewer allocated bytes).
 	Memory& operator=(const Memory& memory);
 
 	// Gets the data contained in this memory module as a comma-seperated string.
 	std::string getDataAsStr() const;
+
+	// Shares the data w/o copying it; whichever side is written to first copies it then (copy-on-write). Copy constructing a 
+	// module shares its data the same way. This is what lets NES snapshots and clones share a cartridge (see NESSnapshot).
+	std::shared_ptr<const std::vector<uint8_t>> share() const;
+	void restore(const std::shared_ptr<const std::vector<uint8_t>>& data);  // Replaces the data (and size) w/ shared data.
 private:
-	std::vector<uint8_t> data;  // Might change from vector to array if this proves too slow..
+	void unshare();  // Gives this module its own copy of the data if it is shared; must be called before writing to it.
+
+	std::shared_ptr<std::vector<uint8_t>> data;  // Might change from vector to array if this proves too slow..
 	friend Memory;
 };
\ No newline at end of file
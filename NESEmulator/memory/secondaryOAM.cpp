@@ -1,12 +1,10 @@
 #include "secondaryOAM.h"
 
-SecondaryOAM::SecondaryOAM() : Memory(0x20), writeEnabled(true), freeByteIdx(0) {}
-
-SecondaryOAM::~SecondaryOAM() {}
+SecondaryOAM::SecondaryOAM() : FixedMemory(), writeEnabled(true), freeByteIdx(0) {}
 
 uint8_t SecondaryOAM::setByte(uint16_t address, uint8_t value) {
 	if (this->writeEnabled) {
-		return Memory::setByte(address, value);
+		return FixedMemory::setByte(address, value);
 	}
 
 	return 0;
@@ -38,3 +36,11 @@ bool SecondaryOAM::setWriteState(bool writeState) {
 bool SecondaryOAM::getWriteState() const {
 	return this->writeEnabled;
 }
+
+uint8_t SecondaryOAM::getFreeByteIdx() const {
+	return this->freeByteIdx;
+}
+
+void SecondaryOAM::setFreeByteIdx(uint8_t idx) {
+	this->freeByteIdx = idx;
+}
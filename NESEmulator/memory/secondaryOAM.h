@@ -1,17 +1,18 @@
 #pragma once
 
-#include "memory.h"
+#include "fixedMemory.hpp"
+
+constexpr int SECONDARY_OAM_SIZE = 0x20;
 
 // An interface for secondary OAM, which is fixed at 256 bytes; the difference between this and a 
 // regular memory module is that it is able to disable writes 
 // (so calling the setByte method of this wouldn't cause any errors, but it won't do anything.)
-class SecondaryOAM : public Memory {
+class SecondaryOAM : public FixedMemory<SECONDARY_OAM_SIZE> {
 public:
 	SecondaryOAM();
-	~SecondaryOAM();
 
 	// NOTE: Might make private. This also does not change what bytes are free or not.
-	uint8_t setByte(uint16_t address, uint8_t value) override;
+	uint8_t setByte(uint16_t address, uint8_t value);
 
 	// Sets the first free byte to the given value, marks it as unfree. Also locks further writing when all free bytes are used.
 	uint8_t setFreeByte(uint8_t value);
@@ -25,6 +26,10 @@ public:
 	// Returns the current writeEnabled state.
 	bool getWriteState() const;
 
+	// Gets/sets the index of the next free byte; used for saving and restoring the state of secondary OAM.
+	uint8_t getFreeByteIdx() const;
+	void setFreeByteIdx(uint8_t idx);
+
 private:
 	bool writeEnabled;
 	uint8_t freeByteIdx;  // An index pointing to the current free byte.
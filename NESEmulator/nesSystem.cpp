@@ -0,0 +1,40 @@
+#include "nesSystem.h"
+
+NESSystem::NESSystem() {
+	this->attachCPU(&this->parts.CPU);
+	this->attachPPU(&this->parts.ppu);
+	this->attachVRAM(&this->parts.VRAM);
+	this->attachRAM(&this->parts.ram);
+	this->attachCartridgeMemory(&this->parts.cartridgeMemory);
+	this->attachDataBus(&this->parts.databus);
+	this->attachController(&this->parts.controller);
+	this->parts.ppu.attachFrameBuffer(&this->parts.frameBuffer);
+}
+
+NESSystem::~NESSystem() {}
+
+std::unique_ptr<NESSystem> NESSystem::clone() const {
+	std::unique_ptr<NESSystem> copy = std::make_unique<NESSystem>();
+	if (this->CHRDATA) {
+		// A Memory of its own to restore into (the data is shared until written to), since CHRDATA may be CHR RAM.
+		copy->CHRDATA = std::make_shared<Memory>(*this->CHRDATA);
+		copy->parts.ppu.attachCHRDATA(copy->CHRDATA.get());
+	}
+
+	NESSnapshot snapshot;
+	this->takeSnapshot(snapshot);
+	copy->restore(snapshot);
+	return copy;
+}
+
+StandardController& NESSystem::getController() {
+	return this->parts.controller;
+}
+
+PPU& NESSystem::getPPU() {
+	return this->parts.ppu;
+}
+
+const IndexedFrameBuffer& NESSystem::getFrameBuffer() const {
+	return this->parts.frameBuffer;
+}
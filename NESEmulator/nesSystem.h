@@ -0,0 +1,47 @@
+// nesSystem.h - A NES which owns every one of its parts, for programs which just want to run a game (e.g. batch runs, bots).
+#pragma once
+
+#include <memory>
+
+#include "NESEmulator.h"
+#include "graphics/indexedFrameBuffer.h"
+
+/*
+NES only points to its parts, so the frontend makes and attaches its own (and the debugger swaps in debugging versions of some
+of them). NESSystem holds a standard set of parts, attached when it is made and drawing into its own frame buffer, so a whole
+NES is one object. Nothing which changes is shared between NESSystems (the palette every PPU draws w/ is loaded once and never
+changed), so any number of them can run at once on different threads.
+
+It can not be copied or moved since the NES points into it; use clone for an independent copy, or takeSnapshot/restore to copy 
+what a NES is doing into another one.
+*/
+class NESSystem : public NES {
+public:
+	NESSystem();  // Load a ROM and power on before running it.
+	~NESSystem();
+
+	NESSystem(const NESSystem&) = delete;
+	NESSystem& operator=(const NESSystem&) = delete;
+
+	// Makes a NES which carries on from where this one is but runs on its own; it shares this one's ROM (see NESSnapshot). Making 
+	// one costs a lot more than restoring a snapshot, so searches should keep a few and restore snapshots into them. The copy 
+	// starts w/ the default settings (e.g. video and audio output on).
+	std::unique_ptr<NESSystem> clone() const;
+
+	StandardController& getController();
+	PPU& getPPU();
+	const IndexedFrameBuffer& getFrameBuffer() const;  // The last frame drawn; see NES::setVideoOutput.
+
+private:
+	// Named apart from the NES's pointers to them.
+	struct Parts {
+		VideoRAM VRAM;
+		PPU ppu;
+		NESDatabus databus;
+		RAM ram;
+		Memory cartridgeMemory{ 0x10000 };
+		_6502_CPU CPU;
+		StandardController controller;
+		IndexedFrameBuffer frameBuffer;
+	} parts;
+};
@@ -2,65 +2,45 @@
 
 #include "../globals/helpers.hpp"
 #include "../loadingData/loadPalette.h"
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 
+namespace {
+	// Every PPU draws w/ the same palette, so it is loaded from disk and flattened once, the first time a PPU is made, and then 
+	// shared. Nothing changes it afterwards, so PPUs on any number of threads can read it w/o locking.
+	const PaletteLUT& getSharedPaletteLUT() {
+		static const PaletteLUT LUT = makePaletteLUT(loadPalette("resourceFiles/2C02G_wiki.pal"));
+		return LUT;
+	}
+}
+
 PPU::PPU() : 
-	VRAM(nullptr), 
-	CHRDATA(nullptr), 
-	OAM(Memory{0x100}),
-	paletteControl(Memory{0x20}),
-	cycleCount(0),
-	PPUDATABuffer(0),
-	control(0),
-	mask(0),
-	status(0),
-	OAMAddr(0),
-	w(0),
-	t(0),
-	v(0),
-	x(0),
-	requestingOAMDMA(false),
-	dmaPage(0),
-	ioBus(0),
+	paletteLUT(getSharedPaletteLUT()),
+	frameBuffer(nullptr),
 	graphics(nullptr),
-	latches(),
-	backgroundShiftRegisters(),
-	spriteShiftRegisters(),
-	paletteMap(loadPalette("resourceFiles/2C02G_wiki.pal")),
-	beamPos(),
-	frameCount(0), 
-	spriteEvalCycle()
+	outputEnabled(true),
+	renderInterval(1),
+	frameRequested(false),
+	renderingFrame(true),
+	lastFrameRendered(false),
+	VRAM(nullptr),
+	CHRDATA(nullptr)
 {
 	this->databus.attachPalette(&paletteControl);
 }
 
-PPU::PPU(Memory* VRAM, Memory* CHRDATA) :
-	VRAM(VRAM),
-	CHRDATA(CHRDATA),
-	OAM(Memory{ 0x100 }),
-	paletteControl(Memory{ 0x20 }),
-	cycleCount(0),
-	PPUDATABuffer(0),
-	control(0),
-	mask(0),
-	status(0),
-	OAMAddr(0),
-	w(0),
-	t(0),
-	v(0),
-	x(0),
-	requestingOAMDMA(false),
-	dmaPage(0),
-	ioBus(0),
+PPU::PPU(VideoRAM* VRAM, Memory* CHRDATA) :
+	paletteLUT(getSharedPaletteLUT()),
+	frameBuffer(nullptr),
 	graphics(nullptr),
-	latches(),
-	backgroundShiftRegisters(),
-	spriteShiftRegisters(),
-	paletteMap(loadPalette("resourceFiles/2C02G_wiki.pal")),
-	beamPos(),
-	frameCount(0),
-	spriteEvalCycle()
+	outputEnabled(true),
+	renderInterval(1),
+	frameRequested(false),
+	renderingFrame(true),
+	lastFrameRendered(false),
+	VRAM(VRAM),
+	CHRDATA(CHRDATA)
 {
 	this->databus.attachPalette(&paletteControl);
 }
@@ -71,7 +51,51 @@ void PPU::attachGraphics(Graphics* graphics) {
 	this->graphics = graphics;
 }
 
-void PPU::attachVRAM(Memory* vram) {
+void PPU::attachFrameBuffer(IndexedFrameBuffer* frameBuffer) {
+	this->frameBuffer = frameBuffer;
+}
+
+const PPUState& PPU::getState() const {
+	return *this;
+}
+
+void PPU::loadState(const PPUState& state) {
+	static_cast<PPUState&>(*this) = state;
+}
+
+int PPU::getFrameCount() const {
+	return this->frameCount;
+}
+
+void PPU::setOutputEnabled(bool enabled) {
+	this->outputEnabled = enabled;
+}
+
+bool PPU::getOutputEnabled() const {
+	return this->outputEnabled;
+}
+
+void PPU::setRenderInterval(unsigned int interval) {
+	this->renderInterval = interval > 0 ? interval : 1;
+}
+
+unsigned int PPU::getRenderInterval() const {
+	return this->renderInterval;
+}
+
+void PPU::requestFrame() {
+	this->frameRequested = true;
+}
+
+bool PPU::wasLastFrameRendered() const {
+	return this->lastFrameRendered;
+}
+
+const PaletteLUT& PPU::getPaletteLUT() const {
+	return this->paletteLUT;
+}
+
+void PPU::attachVRAM(VideoRAM* vram) {
 	this->VRAM = vram;
 	this->databus.attachVRAM(vram);
 }
@@ -92,6 +116,10 @@ void PPU::executePPUCycle() {
 		this->drawPixel();
 	}
 
+	if (this->frameBuffer != nullptr && this->outputEnabled && this->renderingFrame) {
+		this->trackFrameBufferLines();
+	}
+
 	this->updateBeamLocation();
 
 	++this->cycleCount;
@@ -264,6 +292,30 @@ bool PPU::reqeuestingDMA() {
 uint8_t PPU::getDMAPage() const {
 	return this->dmaPage;
 }
+bool PPU::isOAMIdleFor(unsigned int dots) const {
+	bool backgroundRendering = getBitVal(this->mask, 3);
+	bool spriteRendering = getBitVal(this->mask, 4);
+	if (!backgroundRendering && !spriteRendering) {
+		return true;
+	}
+
+	// The post-render line and vblank; the pre-render line is left out since it resets OAMADDR.
+	if (this->beamPos.scanline < 240 || this->beamPos.scanline >= PRE_RENDER_LINE) {
+		return false;
+	}
+	int dotsLeft = (PRE_RENDER_LINE - this->beamPos.scanline) * PPU_CYCLES_PER_LINE - this->beamPos.dot;
+	return static_cast<int>(dots) <= dotsLeft;
+}
+
+void PPU::writeOAMPage(const uint8_t* bytes) {
+	// 256 writes starting at OAMADDR wrap all the way around, so OAMADDR ends up where it started.
+	uint8_t* OAMData = this->OAM.getData();
+	size_t firstPart = OAM_SIZE - this->OAMAddr;
+	std::memcpy(OAMData + this->OAMAddr, bytes, firstPart);
+	std::memcpy(OAMData, bytes + firstPart, OAM_SIZE - firstPart);
+	this->ioBus = bytes[OAM_SIZE - 1];
+}
+
 bool PPU::isRendering(bool includePrerender) const {
 	// The PPU is rendering if 1. either background OR sprite rendering is on, 2. it is inbetween scanlines 0 and 239 inclusive.
 	bool backgroundRendering = getBitVal(this->mask, 3);
@@ -677,6 +729,11 @@ void PPU::updateSpriteShiftRegisters() {
 void PPU::updateBeamLocation() { 
 	if (this->beamPos.updatePosition(this->frameCount & 1)) {
 		++this->frameCount;
+
+		// Decide whether the frame which just started gets composed.
+		this->lastFrameRendered = this->renderingFrame && this->outputEnabled;
+		this->renderingFrame = this->frameRequested || static_cast<unsigned int>(this->frameCount) % this->renderInterval == 0;
+		this->frameRequested = false;
 	}
 }
 void PPU::incrementScrolling(bool axis) {  // Increments scrolling
@@ -810,79 +867,115 @@ bool PPU::getSpritePatternAndColor(uint8_t& pattern, uint8_t& color) {
 	return 0;
 }
 void PPU::drawPixel() {
+	if (this->beamPos.dot < 0x100 && this->beamPos.scanline < 0xf0) {  // Do not draw past dot 256 or scanline 240
+		// The sprite 0 hit is the only part of drawing which affects the emulation, so it is done for every frame.
+		this->updateSprite0Hit();
+
+		if (this->outputEnabled && this->renderingFrame && (this->graphics != nullptr || this->frameBuffer != nullptr)) {
+			this->composePixel();
+		}
+	}
+}
+void PPU::trackFrameBufferLines() {
+	// Done whether or not rendering is enabled, since a line which is not drawn can still differ from the last frame's.
+	if (this->beamPos.scanline == 0 && this->beamPos.dot == 0) {
+		this->frameBuffer->beginFrame();
+	} else if (this->beamPos.scanline < static_cast<int>(DISPLAY_HEIGHT) && this->beamPos.dot == static_cast<int>(DISPLAY_WIDTH)) {  // The last pixel of the line is done.
+		this->frameBuffer->finishLine(this->beamPos.scanline);
+	}
+}
+void PPU::updateSprite0Hit() {
 	// Note: "BG" or "bg" stands for background.
 
-	if (this->graphics == nullptr) {  // If we are not given a graphics object, do not attempt to draw.
-		//std::cout << "Warning: No graphics object provided for PPU; no output will be displayed." << std::endl;
+	// Once set, the flag stays set until the pre-render line, so there is nothing left to check.
+	if (getBitVal(this->status, 6) || this->beamPos.dot == 255) {
 		return;
 	}
 
-	if (this->beamPos.dot < 0x100 && this->beamPos.scanline < 0xf0) {  // Do not draw past dot 256 or scanline 240
-		// Get values of the mask bits.
-		bool isGrayscale = getBitVal(this->mask, 0);
-		bool bgRenderingEnabled = getBitVal(this->mask, 4);
-		bool spriteRenderingEnabled = getBitVal(this->mask, 1);
-
-		bool showBGInLeft8Pixels = getBitVal(this->mask, 1);
-		bool showSpritesInLeft8Pixels = getBitVal(this->mask, 2);
-		bool inLeft8Pixels = this->beamPos.dot < 8;
+	bool bgRenderingEnabled = getBitVal(this->mask, 4);
+	bool showBGInLeft8Pixels = getBitVal(this->mask, 1);
+	bool inLeft8Pixels = this->beamPos.dot < 8;
+	if (!bgRenderingEnabled || (inLeft8Pixels && !showBGInLeft8Pixels)) {
+		return;  // The BG is treated as transparent.
+	}
 
-		bool showBG = bgRenderingEnabled && (!inLeft8Pixels || showBGInLeft8Pixels);
-		bool showSprites = spriteRenderingEnabled && (!inLeft8Pixels || showSpritesInLeft8Pixels);
+	// Check for transparency (the pattern is 0 OR the color index is 0)
+	uint8_t bgPaletteIdx = this->backgroundShiftRegisters.getPattern(this->x);
+	if (bgPaletteIdx == 0 || this->getBGColor(bgPaletteIdx) == 0) {
+		return;
+	}
 
-		bool isSprite0Opaque = this->currentSprite0Opacity();
+	// If the BG is not transparent and neither is sprite 0 at this point, we set the sprite 0 flag.
+	// The sprite is checked last since it is by far the most expensive part.
+	if (!this->currentSprite0Opacity()) {
+		setBit(this->status, 6);
+	}
+}
+void PPU::composePixel() {
+	// Note: "BG" or "bg" stands for background.
 
-		// We will figure out what color we need to draw.
-		uint16_t colorKey = 0;//this->databus.read(0x3f00);  // Transparent pixels use the color at 0x3f00 by default.
+	// Get values of the mask bits.
+	bool isGrayscale = getBitVal(this->mask, 0);
+	bool bgRenderingEnabled = getBitVal(this->mask, 4);
+	bool spriteRenderingEnabled = getBitVal(this->mask, 1);
 
-		// First, copy the emphasis values from PPUMASK to the color key.
-		copyBits(colorKey, 6, 8, (uint16_t)this->mask, 5, 7);
+	bool showBGInLeft8Pixels = getBitVal(this->mask, 1);
+	bool showSpritesInLeft8Pixels = getBitVal(this->mask, 2);
+	bool inLeft8Pixels = this->beamPos.dot < 8;
 
-		// Now we have to find the color index for this pixel.
-		// Getting the high and low bits of the pattern at the appropriate point.
+	bool showBG = bgRenderingEnabled && (!inLeft8Pixels || showBGInLeft8Pixels);
+	bool showSprites = spriteRenderingEnabled && (!inLeft8Pixels || showSpritesInLeft8Pixels);
 
-		// Now we figure out the color index to use; this is based on multiple factors
-	
-		// If a component's rendering is disabled OR it is in the left 8 pixels when , then treat it as transparent.
-		uint8_t bgColorIdx = 0;  // Note: bg stands for background.
-		uint8_t bgPaletteIdx = 0;
-
-		uint8_t spritePaletteIdx = 0;
-		uint8_t spriteColorIdx = 0;
-		bool isSpritePrioritized = false;
-		if (showBG) {
-			bgPaletteIdx = this->backgroundShiftRegisters.getPattern(this->x);
-			bgColorIdx = this->getBGColor(bgPaletteIdx);
-		} 
-		if (showSprites) {
-			isSpritePrioritized = this->getSpritePatternAndColor(spritePaletteIdx, spriteColorIdx);
-		}
+	// We will figure out what color we need to draw.
+	uint16_t colorKey = 0;//this->databus.read(0x3f00);  // Transparent pixels use the color at 0x3f00 by default.
 
-		// Check for transparency (the pattern is 0 OR the color index is 0)
-		bool bgTransparent = bgPaletteIdx == 0 || bgColorIdx == 0;
-		bool spriteTransparent = spritePaletteIdx == 0 || spriteColorIdx == 0;
+	// First, copy the emphasis values from PPUMASK to the color key.
+	copyBits(colorKey, 6, 8, (uint16_t)this->mask, 5, 7);
 
-		// If the BG is not transparent and neither is sprite 0 at this point, we set the sprite 0 flag.
-		if (!isSprite0Opaque && !bgTransparent && this->beamPos.dot != 255) {
-			setBit(this->status, 6);
-			
-		}
+	// Now we have to find the color index for this pixel.
+	// Getting the high and low bits of the pattern at the appropriate point.
 
-		// Now, if the sprite is prioritized AND it is not transparent OR the background is transparent, we show the sprite color. Otherwise we show the background color.
-		if (bgTransparent && spriteTransparent) {
-			// If both are transparent, default to the first color in the palette at adress 0x3f00.
-			colorKey |= this->databus.read(0x3f00);
-		} else if ((isSpritePrioritized && !spriteTransparent) || bgTransparent) {
-			colorKey |= spriteColorIdx;
-		} else {
-			colorKey |= bgColorIdx;
-		}
+	// Now we figure out the color index to use; this is based on multiple factors
+	
+	// If a component's rendering is disabled OR it is in the left 8 pixels when , then treat it as transparent.
+	uint8_t bgColorIdx = 0;  // Note: bg stands for background.
+	uint8_t bgPaletteIdx = 0;
+
+	uint8_t spritePaletteIdx = 0;
+	uint8_t spriteColorIdx = 0;
+	bool isSpritePrioritized = false;
+	if (showBG) {
+		bgPaletteIdx = this->backgroundShiftRegisters.getPattern(this->x);
+		bgColorIdx = this->getBGColor(bgPaletteIdx);
+	} 
+
+	// Check for transparency (the pattern is 0 OR the color index is 0)
+	bool bgTransparent = bgPaletteIdx == 0 || bgColorIdx == 0;
+
+	if (showSprites) {
+		isSpritePrioritized = this->getSpritePatternAndColor(spritePaletteIdx, spriteColorIdx);
+	}
+	bool spriteTransparent = spritePaletteIdx == 0 || spriteColorIdx == 0;
+
+	// Now, if the sprite is prioritized AND it is not transparent OR the background is transparent, we show the sprite color. Otherwise we show the background color.
+	if (bgTransparent && spriteTransparent) {
+		// If both are transparent, default to the first color in the palette at adress 0x3f00.
+		colorKey |= this->databus.read(0x3f00);
+	} else if ((isSpritePrioritized && !spriteTransparent) || bgTransparent) {
+		colorKey |= spriteColorIdx;
+	} else {
+		colorKey |= bgColorIdx;
+	}
 
-		// One last check; if we are in grayscale mode, AND the byte w/ 0x30
-		if (isGrayscale) colorKey &= 0x30;
+	// One last check; if we are in grayscale mode, AND the byte w/ 0x30
+	if (isGrayscale) colorKey &= 0x30;
 
-		// Finally, we draw the pixel.
-		this->graphics->drawPixel(this->paletteMap.at(colorKey), this->beamPos.dot, this->beamPos.scanline);
+	// Finally, we draw the pixel.
+	if (this->frameBuffer != nullptr) {
+		this->frameBuffer->setPixel(this->beamPos.dot, this->beamPos.scanline, colorKey);
+	}
+	if (this->graphics != nullptr) {
+		this->graphics->drawPixel(this->paletteLUT[colorKey & (PALETTE_LUT_SIZE - 1)], this->beamPos.dot, this->beamPos.scanline);
 	}
 }
 
@@ -894,7 +987,6 @@ BackgroundShiftRegisters::BackgroundShiftRegisters() :
 	attributeShiftRegisterLow(0),
 	attributeShiftRegisterHigh(0)
 {}
-BackgroundShiftRegisters::~BackgroundShiftRegisters() {}
 uint8_t BackgroundShiftRegisters::getPattern(int x) const {
 	uint8_t pattern = getBitVal(this->patternShiftRegisterHigh, x) << 1;  // Fetching the high bit.
 	pattern += getBitVal(this->patternShiftRegisterLow, x);  // Then the low bit.
@@ -928,11 +1020,9 @@ BackgroundLatches::BackgroundLatches() :
 	attributeLatchHigh(0),
 	nametableByteLatch(0)
 {}
-BackgroundLatches::~BackgroundLatches() {}
 
 PPUPosition::PPUPosition() : scanline(0), dot(0) {}
 PPUPosition::PPUPosition(int scanline, int dot) : scanline(scanline), dot(dot) {}
-PPUPosition::~PPUPosition() {}
 bool PPUPosition::updatePosition(bool oddFrame) {
 	// First, check if we need to skip dot 340, line 261 (only do this on odd frames).
 	if (oddFrame & 0b1) {  // Check if the frame is odd
@@ -1039,7 +1129,6 @@ SpriteShiftUnit::SpriteShiftUnit() :
 	attributeBits(0),
 	x(0)
 {}
-SpriteShiftUnit::~SpriteShiftUnit() {}
 uint8_t SpriteShiftUnit::getPattern(int x) const {
 	x = 7 - x;  // Keep in mind that the index starts from left to right.
 	if (this->patternShiftRegisterLow & 0xff) {
@@ -1082,7 +1171,6 @@ SpriteShiftUnit& SpriteShiftUnit::operator<<=(int n) {
 }
 
 SpriteShiftRegisters::SpriteShiftRegisters() {}
-SpriteShiftRegisters::~SpriteShiftRegisters() {}
 SpriteShiftUnit& SpriteShiftRegisters::at(int idx) {
 	// If an invalid index is given, default to index 0.
 	if (idx >= 8 || idx < 0) {
@@ -1105,7 +1193,6 @@ void SpriteShiftRegisters::operator<<=(const int& n) {
 }
 
 SpriteEvalCycle::SpriteEvalCycle() : byteType(Y_COORD), evalState(INIT) {}
-SpriteEvalCycle::~SpriteEvalCycle() {}
 void SpriteEvalCycle::operator++() {
 	switch (this->byteType) {
 	case(Y_COORD):
@@ -12,8 +12,9 @@
 #include "../memory/secondaryOAM.h"
 #include "../databus/ppuDatabus.h"
 #include "../graphics/graphics.h"
+#include "../graphics/indexedFrameBuffer.h"
 
-const int VRAM_SIZE = 0x800;  // The size of the internal VRAM that the NES has in bytes.
+const int OAM_SIZE = 0x100;  // 4 bytes for each of the 64 sprites.
 
 // Lines are 0-based indexed from 0 to 260; lines 0 to 239 are visible, 240 is the post-render line, 241 to 260 are the VBlank lines, and 261 is the pre-render line.
 // The following values are the lines where each respective scanline group STARTS.
@@ -36,7 +37,6 @@ struct BackgroundLatches {
 	uint8_t nametableByteLatch;
 
 	BackgroundLatches();
-	~BackgroundLatches();
 };
 
 struct SpriteShiftUnit {
@@ -45,7 +45,6 @@ struct SpriteShiftUnit {
 	int x;  // The x coordinate of where the sprite is located; used to know when to start rendering this sprite.
 
 	SpriteShiftUnit();
-	~SpriteShiftUnit();
 
 	// Fetches the 2 bits in the low and high shift registers w/ an offset indicating which of the lower 8 bits to get.
 	uint8_t getPattern(int x) const;
@@ -63,7 +62,6 @@ struct BackgroundShiftRegisters {
 	uint16_t attributeShiftRegisterLow, attributeShiftRegisterHigh;  // Contains the attribute data for the given tile.
 
 	BackgroundShiftRegisters();
-	~BackgroundShiftRegisters();
 
 	// Fetches the 2 bits in the low and high shift registers w/ an offset indicating which of the lower 8 bits to get.
 	uint8_t getPattern(int x) const;
@@ -93,7 +91,6 @@ struct SpriteShiftRegisters {
 	std::array<SpriteShiftUnit, 8> shiftRegisters;  // 8 shift registers for 8 sprites in secondary OAM.
 
 	SpriteShiftRegisters();
-	~SpriteShiftRegisters();
 
 	// Returns a reference to a shift unit at the given index.
 	SpriteShiftUnit& at(int idx);
@@ -111,7 +108,6 @@ struct PPUPosition {
 	PPUPosition();
 	PPUPosition(int scanline, int dot);
 	//explicit PPUPosition(const PPUPosition& other);
-	~PPUPosition();
 
 	int scanline, dot;
 
@@ -188,7 +184,6 @@ enum SpriteByteOn {
 class SpriteEvalCycle {
 public:
 	SpriteEvalCycle();
-	~SpriteEvalCycle();
 
 	// Iterates the byteType w/ wrapping.
 	void operator++();
@@ -204,14 +199,72 @@ public:
 	SpriteEvaluationState evalState;
 };
 
-class PPU {
+// Every mutable value inside the PPU; excludes VRAM and CHRDATA since those live outside of it. This is kept trivially copyable
+// so a snapshot of the PPU is a plain copy of this struct. The PPU inherits from it, so it uses these members directly.
+struct PPUState {
+	// Internal latches which will transfer to the shift registers every 8 cycles.  
+	BackgroundLatches latches;
+	// Internal shift registers relating to drawing.
+	BackgroundShiftRegisters backgroundShiftRegisters;
+	// NOTE: There is little information on where sprite patterns are located; I am assuming there are 8 shift registers. 
+	// This part of the emulator is highly speculative due to lack of information.
+	SpriteShiftRegisters spriteShiftRegisters;  
+	
+	PPUPosition beamPos;  // Represents the current dot and scanline 
+	int cycleCount = 0, frameCount = 0;  // NOTE: there might be issues with overflow; look into this risk more.
+
+	PaletteRAM paletteControl;
+	FixedMemory<OAM_SIZE> OAM;  // Internal memory inside the PPU which contains 256 bytes, 4 bytes defining 1 sprite for 64 sprites.
+	SecondaryOAM secondaryOAM;  // used for rendering sprites.
+	SpriteEvalCycle spriteEvalCycle;
+	
+	//uint8_t spriteIdx;  // Part of sprite evaluation.
+	//uint8_t erroneousByteIdx;  // Part of sprite evaluation. During sprite overflow check, the PPU erroneously increments the address of OAM it is using to access by 5 instead of 4.
+
+	// NOTE: I likely will refactor sprite evaluation. In particular, I might try a state machine. The current implementation is also a state machine, but it is cobbled together very poorly.
+
+	bool requestingOAMDMA = false;  // Whether the PPU is requesting an OAMDMA. This gets set true when a write to OAMDMA occurs and false when the requestingDMA method is called and this is true.
+	uint8_t dmaPage = 0;
+
+	// Internal registers.
+	bool w = false;  // 1 bit
+	uint16_t v = 0, t = 0;  // 15 bits
+	uint8_t x = 0;  // 3 bits
+	// Misc.
+	uint8_t control = 0;  // Written via PPUCTRL.
+	uint8_t mask = 0;  // Written via PPUMASK.
+	uint8_t status = 0;  // Read via PPUSTATUS
+	uint8_t OAMAddr = 0;
+
+	uint8_t PPUDATABuffer = 0;  // A buffer to hold the value at the last VRAM address; used in conjunction w/ reads on PPUDATA.
+	uint8_t ioBus = 0;  // The I/O data bus; this must be at least partly emulated to make some PPU register read/write operations work. It is also used for primary-to-secondary OAM data transfer.
+	
+	/* This is mainly because of 1. reads to write - only registers should return the I / O bus value; 2. PPUSTATUS returns the first 5 bits of this bus.
+	 On the actual console, the values in this bus decay, but I won't emulate that (for now?).
+	
+	"PPU open bus holds the last value the CPU wrote to or read from any PPU register (CPU $2000-3FFF). Even if writing to a read-only PPU register, 
+	the PPU's internal bus is still updated with that value. When you read from a PPU register, you get this open bus value in these 3 cases:
+
+	1. Reading from $2000, $2001, $2003, $2004 (except on the 2C02G-0 and H-0), $2005, or $2006
+	2. In bits 4-0 when reading from $2002
+	3. In bits 7-6 when reading from palette RAM ($3F00-3FFF) via $2007 on 2C02G-0 and H-0.
+
+	PPU open bus eventually decays, but it takes at least a few milliseconds after the value was last set. Reading PPU open bus does not set the value, 
+	so for example, repeatedly reading $2002 will keep bits 7-5 active while bits 4-0 eventually decay."
+
+	 - Fiskbit, NesDev forums admin
+	*/	
+};
+
+class PPU : protected PPUState {
 public:
 	PPU();
-	PPU(Memory* VRAM, Memory* CHRDATA);
+	PPU(VideoRAM* VRAM, Memory* CHRDATA);
 	~PPU();
 
 	void attachGraphics(Graphics* graphics);
-	void attachVRAM(Memory* vram);
+	void attachFrameBuffer(IndexedFrameBuffer* frameBuffer);
+	void attachVRAM(VideoRAM* vram);
 	void attachCHRDATA(Memory* chrdata);
 
 	// Executes a single PPU cycle.
@@ -229,6 +282,33 @@ public:
 	// Whether the PPU wants to halt the CPU and do OAM DMA copying.
 	bool reqeuestingDMA();
 	uint8_t getDMAPage() const;  // Gets the page to perform the copying on.
+	// Whether OAM is left alone for the next given number of dots, i.e. rendering is off or the dots all fall between the last 
+	// visible line and the pre-render line. Writes to OAMDATA during such dots all land and nothing looks at OAM until they are done.
+	bool isOAMIdleFor(unsigned int dots) const;
+	// Does what writing each of the 256 bytes to OAMDATA does while OAM is idle (see isOAMIdleFor); used by OAM DMA.
+	void writeOAMPage(const uint8_t* bytes);
+
+	// Gets/loads every internal value of the PPU (excludes VRAM and CHRDATA) in one go.
+	const PPUState& getState() const;
+	void loadState(const PPUState& state);
+
+	int getFrameCount() const;  // The number of frames the PPU has started since power on.
+
+	// Whether pixels are drawn to the graphics object. When disabled, the PPU still does everything that affects the emulation
+	// (e.g. sprite 0 hits) but skips working out and drawing the color of each pixel; used for frames which are never shown.
+	void setOutputEnabled(bool enabled);
+	bool getOutputEnabled() const;
+
+	// Frame skipping for when most frames are never looked at (e.g. fast-forwarding or running headless). Only every interval-th 
+	// frame (counted by getFrameCount) is composed; the others get the same timing, sprite 0 hits, etc. but no pixels. requestFrame 
+	// makes the next frame be composed regardless of the interval. An interval of 1 (the default) composes every frame.
+	void setRenderInterval(unsigned int interval);
+	unsigned int getRenderInterval() const;
+	void requestFrame();
+	bool wasLastFrameRendered() const;  // Whether the last frame to finish was composed, i.e. whether the output holds a new picture.
+
+	// The table used to convert the color keys in an IndexedFrameBuffer to RGBA.
+	const PaletteLUT& getPaletteLUT() const;
 
 protected:
 
@@ -260,19 +340,23 @@ protected:
 	bool getSpritePatternAndColor(uint8_t& pattern, uint8_t& color);
 
 	void drawPixel();  // Draws a pixel to graphics depending on the internal register values. (see the NESdev's page on PPU Rendering for details).
+	void updateSprite0Hit();  // The part of drawing a pixel which affects the emulation; done even when the pixel is not composed.
+	void composePixel();  // Works out the color of the current pixel and outputs it.
+	void trackFrameBufferLines();  // Tells the frame buffer when a frame starts and when each line is finished so it can find changed lines.
 	
 
-	const std::map<uint16_t, uint32_t> paletteMap;
-
-	// Internal latches which will transfer to the shift registers every 8 cycles.  
-	BackgroundLatches latches;
-	// Internal shift registers relating to drawing.
-	BackgroundShiftRegisters backgroundShiftRegisters;
-	// NOTE: There is little information on where sprite patterns are located; I am assuming there are 8 shift registers. 
-	// This part of the emulator is highly speculative due to lack of information.
-	SpriteShiftRegisters spriteShiftRegisters;  
+	const PaletteLUT& paletteLUT;  // The palette shared by every PPU (see ppu.cpp).
 	
-	Graphics* graphics;  // A pointer to the graphics object which will be drawn to.
+	// What the PPU outputs to; either or both may be attached. The frame buffer is the cheaper of the two since it stores color keys, 
+	// while graphics gets the RGBA color (this is mainly for the debugger, which draws over the picture).
+	IndexedFrameBuffer* frameBuffer;
+	Graphics* graphics;
+	bool outputEnabled;  // Not part of PPUState; it is a setting of the frontend, not of the PPU. Neither is anything below.
+
+	unsigned int renderInterval;
+	bool frameRequested;  // Whether requestFrame was called since the current frame started.
+	bool renderingFrame;  // Whether the current frame is being composed.
+	bool lastFrameRendered;
 
 	/*
 	VERY IMPORTANT NOTE FOR INES FILES!!!
@@ -282,57 +366,12 @@ protected:
 	initialized by the program itself, because it's all RAM.
 	*/
 	
-	PPUPosition beamPos;  // Represents the current dot and scanline 
-	int cycleCount, frameCount;  // NOTE: there might be issues with overflow; look into this risk more.
-	
 	// VRAM (NOTE: for now) should contain 2kb (or 0x800 bytes) which span 0x1000 addresses (0x2000 to 0x2fff)
 	// CHRDATA is mapped to some rom or ram data spanning from 0x0000 to 0x2000 (they are the two pattern tables; each of which is 0x1000 bytes big).
 	// 0x3000 to 0x3eff mirror 0x2000 to 0x2eff; it goes unused.
 	// 0x3f00 to 0x3fff maps to the palette control.
 
 	PPUDatabus databus;  // Databus which maps to VRAM, CHRDATA, and palette RAM. This is NOT connected to OAM, which has its own memory.
-	Memory* VRAM;  // TODO: replace memory w/ a specific child of it designed for VRAM; allow this to be remapped by the cartridge.
+	VideoRAM* VRAM;  // TODO: allow this to be remapped by the cartridge.
 	Memory* CHRDATA; 
-	Memory paletteControl;
-	Memory OAM;  // Internal memory inside the PPU which contains 256 bytes, 4 bytes defining 1 sprite for 64 sprites.
-	SecondaryOAM secondaryOAM;  // used for rendering sprites.
-	SpriteEvalCycle spriteEvalCycle;
-	
-	//uint8_t spriteIdx;  // Part of sprite evaluation.
-	//uint8_t erroneousByteIdx;  // Part of sprite evaluation. During sprite overflow check, the PPU erroneously increments the address of OAM it is using to access by 5 instead of 4.
-
-	// NOTE: I likely will refactor sprite evaluation. In particular, I might try a state machine. The current implementation is also a state machine, but it is cobbled together very poorly.
-
-	bool requestingOAMDMA;  // Whether the PPU is requesting an OAMDMA. This gets set true when a write to OAMDMA occurs and false when the requestingDMA method is called and this is true.
-	uint8_t dmaPage;
-
-	// Internal registers.
-	bool w;  // 1 bit
-	uint16_t v, t;  // 15 bits
-	uint8_t x;  // 3 bits
-	// Misc.
-	uint8_t control;  // Written via PPUCTRL.
-	uint8_t mask;  // Written via PPUMASK.
-	uint8_t status;  // Read via PPUSTATUS
-	uint8_t OAMAddr;
-
-	uint8_t PPUDATABuffer;  // A buffer to hold the value at the last VRAM address; used in conjunction w/ reads on PPUDATA.
-	uint8_t ioBus;  // The I/O data bus; this must be at least partly emulated to make some PPU register read/write operations work. It is also used for primary-to-secondary OAM data transfer.
-	
-	/* This is mainly because of 1. reads to write - only registers should return the I / O bus value; 2. PPUSTATUS returns the first 5 bits of this bus.
-	 On the actual console, the values in this bus decay, but I won't emulate that (for now?).
-	
-	"PPU open bus holds the last value the CPU wrote to or read from any PPU register (CPU $2000-3FFF). Even if writing to a read-only PPU register, 
-	the PPU's internal bus is still updated with that value. When you read from a PPU register, you get this open bus value in these 3 cases:
-
-	1. Reading from $2000, $2001, $2003, $2004 (except on the 2C02G-0 and H-0), $2005, or $2006
-	2. In bits 4-0 when reading from $2002
-	3. In bits 7-6 when reading from palette RAM ($3F00-3FFF) via $2007 on 2C02G-0 and H-0.
-
-	PPU open bus eventually decays, but it takes at least a few milliseconds after the value was last set. Reading PPU open bus does not set the value, 
-	so for example, repeatedly reading $2002 will keep bits 7-5 active while bits 4-0 eventually decay."
-
-	 - Fiskbit, NesDev forums admin
-	*/	
-
 };
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "audioSink.h"
+
+#include "../savestates/saveState.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+	const uint32_t WAV_HEADER_SIZE = 44;
+	const uint32_t UNKNOWN_SIZE = 0xffffffff;
+
+	void appendU16(std::vector<uint8_t>& bytes, uint16_t value) {
+		bytes.push_back(value & 0xff);
+		bytes.push_back(value >> 8);
+	}
+
+	void appendU32(std::vector<uint8_t>& bytes, uint32_t value) {
+		appendU16(bytes, value & 0xffff);
+		appendU16(bytes, value >> 16);
+	}
+
+	void appendTag(std::vector<uint8_t>& bytes, const char* tag) {
+		bytes.insert(bytes.end(), tag, tag + 4);
+	}
+}
+
+AudioSink::AudioSink(AudioFormat::AudioFormat format, const std::string& path, unsigned int sampleRate, const std::string& hashPath, unsigned int maxQueuedFrames) :
+	format(format),
+	sampleRate(sampleRate),
+	maxQueuedFrames(std::max(maxQueuedFrames, 1u)),
+	output(nullptr),
+	opened(true),
+	frameNumber(0),
+	stopping(false),
+	framesSubmitted(0),
+	framesWritten(0),
+	samplesWritten(0),
+	writeFailed(false)
+{
+	if (format == AudioFormat::NONE) {
+		// Nothing but the hashes.
+	} else if (path == "-") {
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);  // Otherwise every 0x0a byte written gets a 0x0d put before it.
+#endif
+		this->output = &std::cout;
+	} else {
+		this->file.open(path, std::ios::binary);
+		this->output = &this->file;
+		this->opened = this->file.is_open();
+	}
+
+	if (!hashPath.empty()) {
+		this->hashFile.open(hashPath);
+		this->opened &= this->hashFile.is_open();
+	}
+
+	if (this->opened && format == AudioFormat::WAV) {
+		this->writeWAVHeader(this->output == &std::cout ? UNKNOWN_SIZE : 0);
+	}
+
+	this->worker = std::thread(&AudioSink::run, this);
+}
+
+AudioSink::~AudioSink() {
+	{
+		std::lock_guard<std::mutex> lock{ this->mutex };
+		this->stopping = true;
+	}
+	this->frameQueued.notify_one();
+	this->worker.join();
+
+	if (this->output == &this->file && this->opened && this->format == AudioFormat::WAV && !this->writeFailed) {
+		this->file.seekp(0);
+		this->writeWAVHeader(static_cast<uint32_t>(std::min<unsigned long long>(this->samplesWritten * 2, UNKNOWN_SIZE - WAV_HEADER_SIZE)));
+	}
+	if (this->output != nullptr) {
+		this->output->flush();
+	}
+}
+
+bool AudioSink::isOpen() const {
+	return this->opened;
+}
+
+void AudioSink::submitFrame(const int16_t* samples, size_t count) {
+	if (!this->opened) {
+		return;
+	}
+	++this->framesSubmitted;
+
+	std::unique_lock<std::mutex> lock{ this->mutex };
+	this->frameWritten.wait(lock, [this]() { return this->queuedFrames.size() < this->maxQueuedFrames; });
+
+	std::vector<int16_t> frame;
+	if (!this->freeFrames.empty()) {
+		frame = std::move(this->freeFrames.back());
+		this->freeFrames.pop_back();
+	}
+	frame.assign(samples, samples + count);
+	this->queuedFrames.push_back(std::move(frame));
+	lock.unlock();
+
+	this->frameQueued.notify_one();
+}
+
+AudioSinkStats AudioSink::getStats() const {
+	AudioSinkStats stats;
+	stats.framesSubmitted = this->framesSubmitted;
+	stats.framesWritten = this->framesWritten;
+	stats.samplesWritten = this->samplesWritten;
+	stats.writeFailed = this->writeFailed;
+	return stats;
+}
+
+void AudioSink::run() {
+	std::unique_lock<std::mutex> lock{ this->mutex };
+	while (true) {
+		this->frameQueued.wait(lock, [this]() { return this->stopping || !this->queuedFrames.empty(); });
+		if (this->queuedFrames.empty()) {
+			return;  // Stopping and everything has been written.
+		}
+
+		std::vector<int16_t> frame = std::move(this->queuedFrames.front());
+		this->queuedFrames.pop_front();
+		lock.unlock();
+		this->frameWritten.notify_one();
+
+		this->writeFrame(frame);
+
+		lock.lock();
+		this->freeFrames.push_back(std::move(frame));
+	}
+}
+
+void AudioSink::writeFrame(const std::vector<int16_t>& samples) {
+	this->bytes.clear();
+	for (int16_t sample : samples) {
+		appendU16(this->bytes, static_cast<uint16_t>(sample));
+	}
+
+	if (this->writeFailed) {
+		return;
+	}
+
+	if (this->output != nullptr) {
+		this->output->write(reinterpret_cast<const char*>(this->bytes.data()), this->bytes.size());
+	}
+	if (this->hashFile.is_open()) {
+		this->hashFile << this->frameNumber << ' ' << samples.size() << ' ' << std::hex << std::setw(8) << std::setfill('0')
+					   << crc32(this->bytes.data(), this->bytes.size()) << std::dec << '\n';
+	}
+
+	++this->frameNumber;
+	if ((this->output == nullptr || this->output->good()) && (!this->hashFile.is_open() || this->hashFile.good())) {
+		++this->framesWritten;
+		this->samplesWritten += samples.size();
+	} else {
+		this->writeFailed = true;
+	}
+}
+
+void AudioSink::writeWAVHeader(uint32_t dataSize) {
+	std::vector<uint8_t> header;
+	appendTag(header, "RIFF");
+	appendU32(header, dataSize == UNKNOWN_SIZE ? UNKNOWN_SIZE : dataSize + WAV_HEADER_SIZE - 8);
+	appendTag(header, "WAVE");
+
+	appendTag(header, "fmt ");
+	appendU32(header, 16);  // The size of the rest of the chunk.
+	appendU16(header, 1);  // PCM.
+	appendU16(header, 1);  // Mono.
+	appendU32(header, this->sampleRate);
+	appendU32(header, this->sampleRate * 2);  // Bytes per second.
+	appendU16(header, 2);  // Bytes per sample (for all channels).
+	appendU16(header, 16);  // Bits per sample.
+
+	appendTag(header, "data");
+	appendU32(header, dataSize);
+
+	this->output->write(reinterpret_cast<const char*>(header.data()), header.size());
+}
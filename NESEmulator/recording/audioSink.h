@@ -0,0 +1,84 @@
+// audioSink.h - Writes the APU's output to a WAV or raw PCM file, along w/ a hash of each frame's audio, on a thread of its own.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AudioFormat {
+	enum AudioFormat {
+		WAV,  // 16 bit mono PCM WAV.
+		RAW_PCM,  // Headerless 16 bit little-endian mono samples (e.g. ffmpeg -f s16le -ar 48000 -ac 1 -i -).
+		NONE,  // No audio is written, only the hashes; for comparing builds w/o storing the audio.
+	};
+};
+
+struct AudioSinkStats {
+	unsigned long long framesSubmitted = 0;
+	unsigned long long framesWritten = 0;
+	unsigned long long samplesWritten = 0;
+	bool writeFailed = false;  // Set once a write fails; nothing more is written after that.
+};
+
+/*
+Writes the samples of each frame it is given (see NES::readAudioSamples) to path, or to stdout if path is "-", and if hashPath is
+not empty, a line per frame to hashPath w/ the frame's number, its number of samples and the CRC-32 of its samples (as
+little-endian bytes). Two builds which emulate a movie the same way write the same hashes, so a diff of the hash files shows the
+first frame where the audio changed w/o either build's audio having to be kept.
+
+Like FrameSink, the writing (and hashing) happens on a worker thread and submitFrame only copies the samples into a recycled
+buffer. Unlike FrameSink, nothing is ever dropped since a gap would make the output useless for comparisons: if maxQueuedFrames
+frames are waiting to be written, submitFrame waits for the worker. At a few KB a frame that only happens if the disk cannot keep
+up at all.
+
+The sample rate is only written into the WAV header; it should be what the NES was set to w/ NES::setAudioSampleRate. For output
+which is the same from run to run, leave NES::setAudioRateAdjustment alone, since the rate control depends on timing.
+
+NOTE: When writing to stdout, nothing else may be printed to it. The sizes in a WAV header written to stdout are left at their
+maximum since they can not be filled in afterwards; most tools read such a file to its end.
+*/
+class AudioSink {
+public:
+	AudioSink(AudioFormat::AudioFormat format, const std::string& path, unsigned int sampleRate, const std::string& hashPath = "", unsigned int maxQueuedFrames = 64);
+	~AudioSink();  // Writes every frame still queued, fills in the WAV header's sizes, then closes the output.
+
+	bool isOpen() const;  // Whether the outputs could be opened; if not, submitted frames are ignored.
+
+	// Queues a frame's samples to be written; see above for when this blocks.
+	void submitFrame(const int16_t* samples, size_t count);
+
+	AudioSinkStats getStats() const;
+
+private:
+	void run();
+	void writeFrame(const std::vector<int16_t>& samples);
+	void writeWAVHeader(uint32_t dataSize);
+
+	const AudioFormat::AudioFormat format;
+	const unsigned int sampleRate;
+	const unsigned int maxQueuedFrames;
+
+	std::ofstream file;
+	std::ostream* output;  // file or std::cout; nullptr if no audio is written.
+	std::ofstream hashFile;
+	bool opened;
+	unsigned long long frameNumber;  // Only touched by the worker.
+	std::vector<uint8_t> bytes;  // Reused by the worker for each frame.
+
+	std::vector<std::vector<int16_t>> freeFrames;  // Buffers to copy submitted frames into, kept to reuse their memory.
+	std::deque<std::vector<int16_t>> queuedFrames;
+	std::mutex mutex;  // Guards freeFrames, queuedFrames and stopping.
+	std::condition_variable frameQueued, frameWritten;
+	bool stopping;
+
+	std::atomic<unsigned long long> framesSubmitted, framesWritten, samplesWritten;
+	std::atomic<bool> writeFailed;
+
+	std::thread worker;
+};
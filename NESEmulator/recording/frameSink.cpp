@@ -0,0 +1,200 @@
+#include "frameSink.h"
+
+#include "pngEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+	// NTSC_FRAME_RATE as an exact fraction: the PPU's 236.25 MHz / 44 clock over 89341.5 dots a frame.
+	const char* Y4M_HEADER = "YUV4MPEG2 W256 H240 F39375000:655171 Ip A8:7 C444\n";  // A8:7 is the NES's pixel aspect ratio.
+
+	uint8_t clampToByte(double value) {
+		return static_cast<uint8_t>(std::clamp(std::lround(value), 0l, 255l));
+	}
+
+	bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+		std::ofstream file{ path, std::ios::binary };
+		file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		return file.good();
+	}
+}
+
+FrameSink::FrameSink(FrameFormat::FrameFormat format, const std::string& path, const PaletteLUT& lut, unsigned int queueSize) :
+	format(format),
+	path(path),
+	output(nullptr),
+	opened(false),
+	frameNumber(0),
+	buffers(std::max(queueSize, 1u)),
+	stopping(false),
+	framesSubmitted(0),
+	framesWritten(0),
+	framesDropped(0),
+	writeFailed(false)
+{
+	for (size_t key = 0; key < PALETTE_LUT_SIZE; ++key) {
+		double r = (lut[key] >> 24) & 0xff, g = (lut[key] >> 16) & 0xff, b = (lut[key] >> 8) & 0xff;
+		if (format == FrameFormat::Y4M) {  // BT.601, limited range.
+			this->keyColors[key] = {
+				clampToByte(16 + (65.738 * r + 129.057 * g + 25.064 * b) / 256),
+				clampToByte(128 + (-37.945 * r - 74.494 * g + 112.439 * b) / 256),
+				clampToByte(128 + (112.439 * r - 94.154 * g - 18.285 * b) / 256)
+			};
+		} else {
+			this->keyColors[key] = { static_cast<uint8_t>(r), static_cast<uint8_t>(g), static_cast<uint8_t>(b) };
+		}
+	}
+
+	if (format == FrameFormat::PNG_SEQUENCE) {
+		this->opened = true;  // Each file is opened when its frame is written.
+	} else if (path == "-") {
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);  // Otherwise every 0x0a byte written gets a 0x0d put before it.
+#endif
+		this->output = &std::cout;
+		this->opened = true;
+	} else {
+		this->file.open(path, std::ios::binary);
+		this->output = &this->file;
+		this->opened = this->file.is_open();
+	}
+
+	if (this->opened && format == FrameFormat::Y4M) {
+		this->output->write(Y4M_HEADER, std::char_traits<char>::length(Y4M_HEADER));
+	}
+
+	for (IndexedFrameBuffer& buffer : this->buffers) {
+		this->freeBuffers.push_back(&buffer);
+	}
+	this->worker = std::thread(&FrameSink::run, this);
+}
+
+FrameSink::~FrameSink() {
+	{
+		std::lock_guard<std::mutex> lock{ this->mutex };
+		this->stopping = true;
+	}
+	this->frameQueued.notify_one();
+	this->worker.join();
+
+	if (this->output != nullptr) {
+		this->output->flush();
+	}
+}
+
+bool FrameSink::isOpen() const {
+	return this->opened;
+}
+
+bool FrameSink::submit(const IndexedFrameBuffer& frame, bool wait) {
+	++this->framesSubmitted;
+
+	IndexedFrameBuffer* buffer = nullptr;
+	if (this->opened) {
+		std::unique_lock<std::mutex> lock{ this->mutex };
+		if (wait) {
+			this->bufferFreed.wait(lock, [this]() { return !this->freeBuffers.empty(); });
+		}
+		if (!this->freeBuffers.empty()) {
+			buffer = this->freeBuffers.back();
+			this->freeBuffers.pop_back();
+		}
+	}
+	if (buffer == nullptr) {
+		++this->framesDropped;
+		return false;
+	}
+
+	*buffer = frame;  // The buffer belongs to neither list at this point, so it is copied into w/o holding the lock.
+	{
+		std::lock_guard<std::mutex> lock{ this->mutex };
+		this->queuedBuffers.push_back(buffer);
+	}
+	this->frameQueued.notify_one();
+	return true;
+}
+
+FrameSinkStats FrameSink::getStats() const {
+	FrameSinkStats stats;
+	stats.framesSubmitted = this->framesSubmitted;
+	stats.framesWritten = this->framesWritten;
+	stats.framesDropped = this->framesDropped;
+	stats.writeFailed = this->writeFailed;
+	return stats;
+}
+
+void FrameSink::run() {
+	std::unique_lock<std::mutex> lock{ this->mutex };
+	while (true) {
+		this->frameQueued.wait(lock, [this]() { return this->stopping || !this->queuedBuffers.empty(); });
+		if (this->queuedBuffers.empty()) {
+			return;  // Stopping and everything has been written.
+		}
+
+		IndexedFrameBuffer* buffer = this->queuedBuffers.front();
+		this->queuedBuffers.pop_front();
+		lock.unlock();
+
+		this->writeFrame(*buffer);
+
+		lock.lock();
+		this->freeBuffers.push_back(buffer);
+		this->bufferFreed.notify_one();
+	}
+}
+
+void FrameSink::writeFrame(const IndexedFrameBuffer& frame) {
+	const uint16_t* keys = frame.getPixels();
+	const size_t NUM_PIXELS = DISPLAY_WIDTH * DISPLAY_HEIGHT;
+
+	this->converted.resize(NUM_PIXELS * 3);
+	uint8_t* out = this->converted.data();
+	if (this->format == FrameFormat::Y4M) {  // Planar: all the Y values, then U, then V.
+		for (size_t i = 0; i < NUM_PIXELS; ++i) {
+			const std::array<uint8_t, 3>& yuv = this->keyColors[keys[i] & (PALETTE_LUT_SIZE - 1)];
+			out[i] = yuv[0];
+			out[i + NUM_PIXELS] = yuv[1];
+			out[i + 2 * NUM_PIXELS] = yuv[2];
+		}
+	} else {  // Packed RGB.
+		for (size_t i = 0; i < NUM_PIXELS; ++i) {
+			const std::array<uint8_t, 3>& rgb = this->keyColors[keys[i] & (PALETTE_LUT_SIZE - 1)];
+			out[i * 3] = rgb[0];
+			out[i * 3 + 1] = rgb[1];
+			out[i * 3 + 2] = rgb[2];
+		}
+	}
+
+	bool written = false;
+	if (this->format == FrameFormat::PNG_SEQUENCE) {
+		this->encoded.clear();
+		encodePNG(this->converted.data(), DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_WIDTH * 3, this->encoded);
+
+		std::ostringstream fileName;
+		fileName << this->path << std::setw(6) << std::setfill('0') << this->frameNumber << ".png";
+		written = writeFile(fileName.str(), this->encoded);
+	} else if (!this->writeFailed) {
+		if (this->format == FrameFormat::Y4M) {
+			this->output->write("FRAME\n", 6);
+		}
+		this->output->write(reinterpret_cast<const char*>(this->converted.data()), this->converted.size());
+		this->output->flush();  // Keeps an encoder reading from a pipe fed as frames come in.
+		written = this->output->good();
+	}
+
+	++this->frameNumber;
+	if (written) {
+		++this->framesWritten;
+	} else {
+		this->writeFailed = true;
+	}
+}
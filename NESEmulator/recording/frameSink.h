@@ -0,0 +1,82 @@
+// frameSink.h - Exports frames as raw video (for piping into an encoder) or as a PNG sequence, on a thread of its own.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../graphics/indexedFrameBuffer.h"
+
+namespace FrameFormat {
+	enum FrameFormat {
+		Y4M,  // YUV4MPEG2, 4:4:4 BT.601 at the NTSC frame rate; what ffmpeg and x264 read from a pipe w/o being told the frame size.
+		RAW_RGB,  // Headerless 24 bit RGB frames back to back (e.g. ffmpeg -f rawvideo -pixel_format rgb24 -video_size 256x240 -i -).
+		PNG_SEQUENCE,  // One PNG per frame.
+	};
+};
+
+struct FrameSinkStats {
+	unsigned long long framesSubmitted = 0;
+	unsigned long long framesWritten = 0;
+	unsigned long long framesDropped = 0;  // Submitted while every buffer was still queued, so never written.
+	bool writeFailed = false;  // Set once a write fails; raw video stops being written after that since the stream is broken.
+};
+
+/*
+Writes the frames it is given to a file, stdout or a sequence of PNGs.
+
+Converting and encoding happen on a worker thread so exporting never holds up the emulation: submit only copies the frame into one
+of a fixed number of recycled buffers and queues it. If the worker falls so far behind that every buffer is queued, the frame is
+dropped (and counted) instead of waiting; raise queueSize if that happens on bursts, it only costs 125 KB a buffer.
+
+Y4M and RAW_RGB write to path, or to stdout if path is "-". PNG_SEQUENCE writes path000000.png, path000001.png... so path is the
+directory and prefix of the files (the directory must exist).
+
+NOTE: When writing to stdout, nothing else may be printed to it.
+*/
+class FrameSink {
+public:
+	FrameSink(FrameFormat::FrameFormat format, const std::string& path, const PaletteLUT& lut, unsigned int queueSize = 8);
+	~FrameSink();  // Writes every frame still queued, then closes the output.
+
+	bool isOpen() const;  // Whether the output could be opened; if not, submitted frames are dropped.
+
+	// Queues the frame to be written; returns false if the frame was dropped. Never blocks unless wait is true, in which case it 
+	// waits for a buffer to be free instead of dropping the frame (for offline exports, where every frame matters more than speed).
+	bool submit(const IndexedFrameBuffer& frame, bool wait = false);
+
+	FrameSinkStats getStats() const;
+
+private:
+	void run();
+	void writeFrame(const IndexedFrameBuffer& frame);
+
+	const FrameFormat::FrameFormat format;
+	const std::string path;
+	// What each color key is in the output format: RGB, or YUV for Y4M.
+	std::array<std::array<uint8_t, 3>, PALETTE_LUT_SIZE> keyColors;
+
+	std::ofstream file;
+	std::ostream* output;  // file or std::cout; nullptr for PNG sequences, which open a file per frame.
+	bool opened;
+	unsigned long long frameNumber;  // Only touched by the worker.
+	std::vector<uint8_t> converted, encoded;  // Reused by the worker for each frame.
+
+	std::vector<IndexedFrameBuffer> buffers;
+	std::vector<IndexedFrameBuffer*> freeBuffers;
+	std::deque<IndexedFrameBuffer*> queuedBuffers;
+	std::mutex mutex;  // Guards freeBuffers, queuedBuffers and stopping.
+	std::condition_variable frameQueued, bufferFreed;
+	bool stopping;
+
+	std::atomic<unsigned long long> framesSubmitted, framesWritten, framesDropped;
+	std::atomic<bool> writeFailed;
+
+	std::thread worker;
+};
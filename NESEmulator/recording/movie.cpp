@@ -0,0 +1,248 @@
+#include "movie.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../savestates/saveState.h"
+
+namespace {
+	const char MAGIC[4] = { 'N', 'E', 'S', 'M' };
+	const char KEYFRAME_TAG[4] = { 'K', 'E', 'Y', 'F' };
+	const char INPUT_TAG[4] = { 'I', 'N', 'P', 'T' };
+	const size_t MOVIE_HEADER_SIZE = 12;
+	const size_t RECORD_HEADER_SIZE = 12;  // Tag, frame and length.
+	const size_t CHECKSUM_SIZE = 4;
+}
+
+MovieRecorder::MovieRecorder(const std::string& path, unsigned int keyframeInterval, unsigned int inputBlockFrames) :
+	file(path, std::ios::binary),
+	keyframeInterval(std::max(keyframeInterval, 1u)),
+	inputBlockFrames(std::max(inputBlockFrames, 1u)),
+	frameCount(0)
+{
+	std::vector<uint8_t> header;
+	StateWriter writer{ header };
+	writer.writeBytes(reinterpret_cast<const uint8_t*>(MAGIC), 4);
+	writer.writeU16(MOVIE_VERSION);
+	writer.writeU16(0);
+	writer.writeU32(this->keyframeInterval);
+	this->file.write(reinterpret_cast<const char*>(header.data()), header.size());
+	this->file.flush();
+}
+
+MovieRecorder::~MovieRecorder() {
+	this->writeInputBlock();
+}
+
+bool MovieRecorder::isOpen() const {
+	return this->file.is_open() && this->file.good();
+}
+
+void MovieRecorder::recordFrame(const NES& nes, uint8_t buttons) {
+	if (this->frameCount % this->keyframeInterval == 0) {
+		this->writeInputBlock();  // So the buttons before the keyframe are not held back until the next block.
+		this->keyframe.clear();
+		nes.serializeState(this->keyframe);
+		this->writeRecord(KEYFRAME_TAG, this->frameCount, this->keyframe);
+	}
+
+	this->pendingButtons.push_back(buttons);
+	++this->frameCount;
+	if (this->pendingButtons.size() >= this->inputBlockFrames) {
+		this->writeInputBlock();
+	}
+}
+
+unsigned long long MovieRecorder::getFrameCount() const {
+	return this->frameCount;
+}
+
+void MovieRecorder::writeRecord(const char* tag, unsigned long long frame, const std::vector<uint8_t>& body) {
+	this->record.clear();
+	StateWriter writer{ this->record };
+	writer.writeBytes(reinterpret_cast<const uint8_t*>(tag), 4);
+	writer.writeU32(static_cast<uint32_t>(frame));
+	writer.writeU32(static_cast<uint32_t>(body.size()));
+	writer.writeBytes(body.data(), body.size());
+	writer.writeU32(crc32(body.data(), body.size()));
+
+	// Flushed so the record is on disk even if the file is never closed.
+	this->file.write(reinterpret_cast<const char*>(this->record.data()), this->record.size());
+	this->file.flush();
+}
+
+void MovieRecorder::writeInputBlock() {
+	if (this->pendingButtons.empty()) {
+		return;
+	}
+	this->writeRecord(INPUT_TAG, this->frameCount - this->pendingButtons.size(), this->pendingButtons);
+	this->pendingButtons.clear();
+}
+
+MoviePlayer::MoviePlayer() : keyframeInterval(0), frame(0), firstDesync(-1) {}
+MoviePlayer::~MoviePlayer() {}
+
+MovieResult::MovieResult MoviePlayer::open(const std::string& path) {
+	this->file.close();
+	this->file.clear();
+	this->buttons.clear();
+	this->keyframes.clear();
+	this->frame = 0;
+	this->firstDesync = -1;
+
+	this->file.open(path, std::ios::binary);
+	if (!this->file.is_open()) {
+		return MovieResult::CANT_OPEN_FILE;
+	}
+
+	uint8_t header[MOVIE_HEADER_SIZE];
+	this->file.read(reinterpret_cast<char*>(header), MOVIE_HEADER_SIZE);
+	StateReader headerReader{ header, static_cast<size_t>(this->file.gcount()) };
+	uint8_t magic[4];
+	headerReader.readBytes(magic, 4);
+	uint16_t version = headerReader.readU16();
+	headerReader.skip(2);  // Reserved.
+	this->keyframeInterval = headerReader.readU32();
+	if (headerReader.overran() || std::memcmp(magic, MAGIC, 4) != 0) {
+		return MovieResult::BAD_MAGIC;
+	}
+	if (version > MOVIE_VERSION) {
+		return MovieResult::UNSUPPORTED_VERSION;
+	}
+
+	std::streamoff headerEnd = this->file.tellg();
+	this->file.seekg(0, std::ios::end);
+	std::streamoff fileSize = this->file.tellg();
+	this->file.seekg(headerEnd);
+
+	// Indexes the records. The movie ends at the first one which is cut short, damaged or out of place, since that is where the
+	// recording stopped if the file was not closed.
+	std::vector<uint8_t> body;
+	while (true) {
+		uint8_t recordHeader[RECORD_HEADER_SIZE];
+		this->file.read(reinterpret_cast<char*>(recordHeader), RECORD_HEADER_SIZE);
+		if (static_cast<size_t>(this->file.gcount()) < RECORD_HEADER_SIZE) {
+			break;
+		}
+		StateReader reader{ recordHeader, RECORD_HEADER_SIZE };
+		char tag[4];
+		reader.readBytes(reinterpret_cast<uint8_t*>(tag), 4);
+		unsigned long long recordFrame = reader.readU32();
+		uint32_t length = reader.readU32();
+		std::streamoff offset = this->file.tellg();
+		// A damaged length could ask for gigabytes, so it is checked against what is left of the file before anything is allocated.
+		if (length + static_cast<std::streamoff>(CHECKSUM_SIZE) > fileSize - offset) {
+			break;
+		}
+
+		uint8_t checksumBytes[CHECKSUM_SIZE];
+		if (std::memcmp(tag, INPUT_TAG, 4) == 0) {
+			body.resize(length);
+			this->file.read(reinterpret_cast<char*>(body.data()), length);
+			this->file.read(reinterpret_cast<char*>(checksumBytes), CHECKSUM_SIZE);
+			if (!this->file || recordFrame != this->buttons.size() || StateReader{ checksumBytes, CHECKSUM_SIZE }.readU32() != crc32(body.data(), body.size())) {
+				break;
+			}
+			this->buttons.insert(this->buttons.end(), body.begin(), body.end());
+		} else {
+			// Keyframes are only checked when read.
+			this->file.seekg(length, std::ios::cur);
+			this->file.read(reinterpret_cast<char*>(checksumBytes), CHECKSUM_SIZE);
+			if (!this->file) {
+				break;
+			}
+			if (std::memcmp(tag, KEYFRAME_TAG, 4) == 0) {
+				if (recordFrame != this->buttons.size()) {
+					break;
+				}
+				this->keyframes.push_back({ recordFrame, offset, length, StateReader{ checksumBytes, CHECKSUM_SIZE }.readU32() });
+			}
+		}
+	}
+	this->file.clear();  // Reading to the end of the file set its error flags.
+
+	if (this->keyframes.empty() || this->keyframes.front().frame != 0) {
+		return MovieResult::NO_KEYFRAME;
+	}
+	return MovieResult::SUCCESS;
+}
+
+MovieResult::MovieResult MoviePlayer::seek(NES& nes, unsigned long long frame) {
+	frame = std::min<unsigned long long>(frame, this->buttons.size());
+	const Keyframe* keyframe = this->findKeyframe(frame, false);
+	if (keyframe == nullptr || !this->readKeyframe(*keyframe, this->expectedState)) {
+		return MovieResult::NO_KEYFRAME;
+	}
+	if (nes.deserializeState(this->expectedState.data(), this->expectedState.size()) != SaveStateResult::SUCCESS) {
+		return MovieResult::BAD_KEYFRAME;
+	}
+	nes.flushQueuedButtons();  // Any left over are from another point in time.
+	this->frame = keyframe->frame;
+
+	nes.setVideoOutput(false);
+	nes.setAudioOutput(false);
+	while (this->frame < frame) {
+		this->playFrame(nes);
+		nes.executeFrame();
+	}
+	nes.setVideoOutput(true);
+	nes.setAudioOutput(true);
+
+	return MovieResult::SUCCESS;
+}
+
+bool MoviePlayer::playFrame(NES& nes) {
+	if (this->frame >= this->buttons.size()) {
+		return false;
+	}
+
+	const Keyframe* keyframe = this->findKeyframe(this->frame, true);
+	if (this->firstDesync < 0 && keyframe != nullptr && this->readKeyframe(*keyframe, this->expectedState)) {
+		this->currentState.clear();
+		nes.serializeState(this->currentState);
+		if (this->currentState != this->expectedState) {
+			this->firstDesync = static_cast<long long>(this->frame);
+		}
+	}
+
+	nes.queueButtons(nes.getTotalMachineCycles(), this->buttons[this->frame]);
+	++this->frame;
+	return true;
+}
+
+unsigned long long MoviePlayer::getFrame() const {
+	return this->frame;
+}
+
+unsigned long long MoviePlayer::getFrameCount() const {
+	return this->buttons.size();
+}
+
+unsigned int MoviePlayer::getKeyframeInterval() const {
+	return this->keyframeInterval;
+}
+
+long long MoviePlayer::getFirstDesync() const {
+	return this->firstDesync;
+}
+
+bool MoviePlayer::readKeyframe(const Keyframe& keyframe, std::vector<uint8_t>& state) {
+	state.resize(keyframe.length);
+	this->file.seekg(keyframe.offset);
+	this->file.read(reinterpret_cast<char*>(state.data()), keyframe.length);
+	bool read = static_cast<bool>(this->file);
+	this->file.clear();
+	return read && crc32(state.data(), state.size()) == keyframe.checksum;
+}
+
+const MoviePlayer::Keyframe* MoviePlayer::findKeyframe(unsigned long long frame, bool exact) const {
+	// The last keyframe at or before the frame.
+	auto after = std::upper_bound(this->keyframes.begin(), this->keyframes.end(), frame, [](unsigned long long frame, const Keyframe& keyframe) {
+		return frame < keyframe.frame;
+	});
+	if (after == this->keyframes.begin()) {
+		return nullptr;
+	}
+	const Keyframe* keyframe = &*(after - 1);
+	return !exact || keyframe->frame == frame ? keyframe : nullptr;
+}
@@ -0,0 +1,128 @@
+// movie.h - Records the buttons held on each frame to a movie file w/ savestate keyframes, and plays such movies back.
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../NESEmulator.h"
+
+/*
+FORMAT (all multi-byte values are little-endian):
+
+	Header (12 bytes)
+		char[4]  magic           "NESM"
+		uint16   version         MOVIE_VERSION
+		uint16   reserved        Always 0.
+		uint32   keyframeInterval
+	Records, back to back until the end of the file
+		char[4]  tag             "KEYF" or "INPT"
+		uint32   frame           The first frame the record is about; the first frame recorded is frame 0.
+		uint32   length          Size of the body in bytes.
+		uint8[]  body
+		uint32   checksum        CRC-32 of the body.
+
+	KEYF: a savestate (see saveState.h) of the NES at the start of the frame, before its buttons are set. There is one at frame 0 and
+		  one every keyframeInterval frames after it.
+	INPT: the buttons held (see ControllerButtons) during each frame from frame on, one byte per frame. Blocks follow each other
+		  w/o gaps; a keyframe for frame n comes before the block w/ frame n's buttons.
+
+The file is only ever appended to, a record at a time, so it can be streamed to disk as the movie is recorded; if recording stops
+w/o the file being closed (e.g. a crash), everything up to the last whole record still plays. Unknown tags are skipped.
+*/
+
+const uint16_t MOVIE_VERSION = 1;
+
+namespace MovieResult {
+	enum MovieResult {
+		SUCCESS,
+		CANT_OPEN_FILE,
+		BAD_MAGIC,  // Not a movie.
+		UNSUPPORTED_VERSION,  // Made by a newer version of the emulator.
+		NO_KEYFRAME,  // The movie has no keyframe to start from (or its keyframe is damaged).
+		BAD_KEYFRAME,  // A keyframe would not load into the NES; see SaveStateResult.
+	};
+};
+
+/*
+Writes a movie as it is recorded. recordFrame is called once before each frame is emulated w/ the buttons held during that frame,
+which must not change partway through it (see InputTimeline::flush); frames which are emulated and thrown away (e.g. when running
+ahead) are not recorded. The buttons are written a block of inputBlockFrames frames at a time, and at most that many frames of input
+are lost if the file is not closed. A keyframe is about 21 KB (mostly the cartridge's PRG RAM and CHRDATA), so at the default 
+interval a minute of movie is about 250 KB; the interval is a trade between file size and how many frames a seek has to emulate.
+
+Writing is cheap enough (a byte a frame and a savestate every so often) that it happens on the calling thread.
+*/
+class MovieRecorder {
+public:
+	MovieRecorder(const std::string& path, unsigned int keyframeInterval = 300, unsigned int inputBlockFrames = 60);
+	~MovieRecorder();  // Writes the buttons not yet written and closes the file.
+
+	bool isOpen() const;  // Whether the file could be opened and every write so far succeeded.
+
+	void recordFrame(const NES& nes, uint8_t buttons);
+	unsigned long long getFrameCount() const;
+
+private:
+	void writeRecord(const char* tag, unsigned long long frame, const std::vector<uint8_t>& body);
+	void writeInputBlock();
+
+	std::ofstream file;
+	const unsigned int keyframeInterval;
+	const unsigned int inputBlockFrames;
+
+	unsigned long long frameCount;
+	std::vector<uint8_t> pendingButtons;  // The buttons of the frames not written yet.
+	std::vector<uint8_t> keyframe;  // Reused for each keyframe.
+	std::vector<uint8_t> record;  // Reused for each record.
+};
+
+/*
+Plays a movie back, setting the buttons from the movie instead of whatever the frontend's input is. open reads the buttons of every
+frame and where each keyframe is, but only reads a keyframe when it is needed.
+
+seek loads the last keyframe at or before the frame sought and emulates from there, so it emulates at most keyframeInterval - 1
+frames however far into the movie it goes. While playing, the NES is compared w/ each keyframe it reaches; a difference means the
+emulation no longer does exactly what it did when the movie was recorded, and the first frame where that was seen is kept.
+*/
+class MoviePlayer {
+public:
+	MoviePlayer();
+	~MoviePlayer();
+
+	MovieResult::MovieResult open(const std::string& path);
+
+	// Puts the NES at the start of the given frame (clamped to the movie's length). The frames in between are emulated w/ video and
+	// audio output off, and both are turned back on afterwards.
+	MovieResult::MovieResult seek(NES& nes, unsigned long long frame);
+
+	// Sets the buttons for the next frame, which the caller then emulates. Returns false, doing nothing, once every frame has been played.
+	bool playFrame(NES& nes);
+
+	unsigned long long getFrame() const;  // The next frame to be played.
+	unsigned long long getFrameCount() const;
+	unsigned int getKeyframeInterval() const;
+	// The first frame found to not match its keyframe, or -1 if none has been found.
+	long long getFirstDesync() const;
+
+private:
+	struct Keyframe {
+		unsigned long long frame;
+		std::streamoff offset;  // Where the savestate starts in the file.
+		uint32_t length;
+		uint32_t checksum;
+	};
+
+	bool readKeyframe(const Keyframe& keyframe, std::vector<uint8_t>& state);
+	const Keyframe* findKeyframe(unsigned long long frame, bool exact) const;
+
+	std::ifstream file;
+	unsigned int keyframeInterval;
+	std::vector<uint8_t> buttons;  // The buttons of every frame.
+	std::vector<Keyframe> keyframes;  // In order of their frames.
+
+	unsigned long long frame;
+	long long firstDesync;
+	std::vector<uint8_t> expectedState, currentState;  // Reused when comparing w/ keyframes.
+};
@@ -0,0 +1,186 @@
+#include "pngEncoder.h"
+
+#include "../savestates/saveState.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+	const size_t MIN_MATCH = 3, MAX_MATCH = 258, WINDOW_SIZE = 32768;
+	const unsigned int HASH_BITS = 15;
+
+	// The first length/distance of each deflate length/distance code and how many extra bits follow the code.
+	const std::array<uint16_t, 29> LENGTH_BASE = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const std::array<uint8_t, 29> LENGTH_EXTRA_BITS = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const std::array<uint16_t, 30> DISTANCE_BASE = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const std::array<uint8_t, 30> DISTANCE_EXTRA_BITS = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	// Deflate packs values starting from the least significant bit, except Huffman codes, which go most significant bit first.
+	class BitWriter {
+	public:
+		BitWriter(std::vector<uint8_t>& out) : out(out), bits(0), numBits(0) {}
+
+		void write(uint32_t value, unsigned int length) {
+			this->bits |= static_cast<uint64_t>(value) << this->numBits;
+			this->numBits += length;
+			while (this->numBits >= 8) {
+				this->out.push_back(static_cast<uint8_t>(this->bits));
+				this->bits >>= 8;
+				this->numBits -= 8;
+			}
+		}
+
+		void writeCode(uint32_t code, unsigned int length) {
+			uint32_t reversed = 0;
+			for (unsigned int i = 0; i < length; ++i) {
+				reversed = (reversed << 1) | ((code >> i) & 1);
+			}
+			this->write(reversed, length);
+		}
+
+		void flush() {
+			if (this->numBits > 0) {
+				this->out.push_back(static_cast<uint8_t>(this->bits));
+			}
+			this->bits = 0;
+			this->numBits = 0;
+		}
+
+	private:
+		std::vector<uint8_t>& out;
+		uint64_t bits;
+		unsigned int numBits;
+	};
+
+	// Writes a literal/length symbol w/ the fixed Huffman codes (RFC 1951 3.2.6).
+	void writeSymbol(BitWriter& writer, unsigned int symbol) {
+		if (symbol < 144) {
+			writer.writeCode(0x30 + symbol, 8);
+		} else if (symbol < 256) {
+			writer.writeCode(0x190 + symbol - 144, 9);
+		} else if (symbol < 280) {
+			writer.writeCode(symbol - 256, 7);
+		} else {
+			writer.writeCode(0xc0 + symbol - 280, 8);
+		}
+	}
+
+	void writeMatch(BitWriter& writer, size_t length, size_t distance) {
+		size_t lengthCode = std::upper_bound(LENGTH_BASE.begin(), LENGTH_BASE.end(), length) - LENGTH_BASE.begin() - 1;
+		writeSymbol(writer, 257 + static_cast<unsigned int>(lengthCode));
+		writer.write(static_cast<uint32_t>(length - LENGTH_BASE[lengthCode]), LENGTH_EXTRA_BITS[lengthCode]);
+
+		size_t distanceCode = std::upper_bound(DISTANCE_BASE.begin(), DISTANCE_BASE.end(), distance) - DISTANCE_BASE.begin() - 1;
+		writer.writeCode(static_cast<uint32_t>(distanceCode), 5);
+		writer.write(static_cast<uint32_t>(distance - DISTANCE_BASE[distanceCode]), DISTANCE_EXTRA_BITS[distanceCode]);
+	}
+
+	uint32_t hashAt(const uint8_t* data) {
+		uint32_t next3 = data[0] | (data[1] << 8) | (data[2] << 16);
+		return (next3 * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	// Compresses data as a single fixed Huffman block. rowSize is the distance to the byte above in the image.
+	void deflate(const std::vector<uint8_t>& data, size_t rowSize, std::vector<uint8_t>& out) {
+		BitWriter writer{ out };
+		writer.write(1, 1);  // BFINAL
+		writer.write(1, 2);  // BTYPE = fixed Huffman codes
+
+		std::vector<int64_t> head(size_t(1) << HASH_BITS, -1);  // The last position each hash was seen at.
+		size_t size = data.size();
+		size_t i = 0;
+		while (i < size) {
+			size_t bestLength = 0, bestDistance = 0;
+			if (i + MIN_MATCH <= size) {
+				uint32_t hash = hashAt(&data[i]);
+				size_t maxLength = std::min(MAX_MATCH, size - i);
+				const int64_t candidates[3] = { static_cast<int64_t>(i) - 3, static_cast<int64_t>(i) - static_cast<int64_t>(rowSize), head[hash] };
+				for (int64_t candidate : candidates) {
+					if (candidate < 0 || i - static_cast<size_t>(candidate) > WINDOW_SIZE) {
+						continue;
+					}
+					const uint8_t* match = &data[static_cast<size_t>(candidate)];
+					size_t length = 0;
+					while (length < maxLength && match[length] == data[i + length]) {
+						++length;
+					}
+					if (length > bestLength) {
+						bestLength = length;
+						bestDistance = i - static_cast<size_t>(candidate);
+					}
+				}
+				head[hash] = i;
+			}
+
+			if (bestLength >= MIN_MATCH) {
+				writeMatch(writer, bestLength, bestDistance);
+				for (size_t j = i + 1; j < i + bestLength && j + MIN_MATCH <= size; ++j) {
+					head[hashAt(&data[j])] = j;
+				}
+				i += bestLength;
+			} else {
+				writeSymbol(writer, data[i]);
+				++i;
+			}
+		}
+
+		writeSymbol(writer, 256);  // End of block.
+		writer.flush();
+	}
+
+	uint32_t adler32(const std::vector<uint8_t>& data) {
+		uint32_t a = 1, b = 0;
+		for (size_t i = 0; i < data.size(); ) {
+			size_t end = std::min(data.size(), i + 5552);  // The most bytes which can be summed before b could overflow.
+			for (; i < end; ++i) {
+				a += data[i];
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	void writeU32BE(std::vector<uint8_t>& out, uint32_t value) {
+		out.push_back(static_cast<uint8_t>(value >> 24));
+		out.push_back(static_cast<uint8_t>(value >> 16));
+		out.push_back(static_cast<uint8_t>(value >> 8));
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	void writeChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+		writeU32BE(out, static_cast<uint32_t>(data.size()));
+		size_t typeStart = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		writeU32BE(out, crc32(out.data() + typeStart, out.size() - typeStart));
+	}
+}
+
+void encodePNG(const uint8_t* rgb, unsigned int w, unsigned int h, size_t pitch, std::vector<uint8_t>& out) {
+	const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	out.insert(out.end(), SIGNATURE, SIGNATURE + 8);
+
+	std::vector<uint8_t> header;
+	writeU32BE(header, w);
+	writeU32BE(header, h);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });  // 8 bits per channel, truecolor, deflate, adaptive filtering, no interlace.
+	writeChunk(out, "IHDR", header);
+
+	// Every row is prefixed w/ its filter type; no filter is used since the matcher already looks at the pixel above.
+	size_t rowSize = 1 + static_cast<size_t>(w) * 3;
+	std::vector<uint8_t> rows(rowSize * h);
+	for (unsigned int y = 0; y < h; ++y) {
+		rows[y * rowSize] = 0;
+		std::memcpy(&rows[y * rowSize + 1], rgb + y * pitch, rowSize - 1);
+	}
+
+	std::vector<uint8_t> imageData = { 0x78, 0x01 };  // zlib header: deflate w/ a 32K window, no dictionary.
+	deflate(rows, rowSize, imageData);
+	writeU32BE(imageData, adler32(rows));
+	writeChunk(out, "IDAT", imageData);
+
+	writeChunk(out, "IEND", {});
+}
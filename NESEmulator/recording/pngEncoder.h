@@ -0,0 +1,15 @@
+// pngEncoder.h - A small PNG encoder for writing frames w/o an image library.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*
+Encodes w x h RGB24 pixels (3 bytes a pixel, rows pitch bytes apart) as an 8-bit truecolor PNG, appending the file to out.
+
+Compression is a single deflate block w/ the fixed Huffman codes and greedy LZ77 matching. Besides the usual hash of the next 3
+bytes, the pixel to the left and the pixel above are always tried as matches, which catches the flat areas and repeated tiles
+that make up most of an NES frame; frames come out at a few KB instead of the 180 KB they would be uncompressed.
+*/
+void encodePNG(const uint8_t* rgb, unsigned int w, unsigned int h, size_t pitch, std::vector<uint8_t>& out);
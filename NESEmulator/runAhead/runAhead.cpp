@@ -0,0 +1,87 @@
+#include "runAhead.h"
+
+#include <algorithm>
+
+namespace {
+	const double NTSC_FRAME_MS = 1000.0 / 60.0988;
+
+	double msSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+double RunAheadStats::getAverageFrameMS() const {
+	return this->framesPresented == 0 ? 0 : this->totalFrameMS / this->framesPresented;
+}
+
+double RunAheadStats::getAverageOverheadMS() const {
+	return this->framesPresented == 0 ? 0 : this->totalOverheadMS / this->framesPresented;
+}
+
+double RunAheadStats::getOverheadRatio() const {
+	return this->totalFrameMS == 0 ? 0 : this->totalOverheadMS / this->totalFrameMS;
+}
+
+RunAhead::RunAhead(NES& nes, unsigned int framesAhead) : nes(nes), framesAhead(framesAhead) {}
+RunAhead::~RunAhead() {}
+
+NESCycleOutcomes RunAhead::executeFrame() {
+	if (this->framesAhead == 0) {
+		auto frameStart = std::chrono::steady_clock::now();
+		this->nes.setVideoOutput(true);
+		NESCycleOutcomes result = this->nes.executeFrame();
+
+		this->stats.lastFrameMS = msSince(frameStart);
+		this->stats.lastOverheadMS = 0;
+		this->stats.totalFrameMS += this->stats.lastFrameMS;
+		++this->stats.framesEmulated;
+		++this->stats.framesPresented;
+		return result;
+	}
+
+	// The real frame; it is never shown since the frame ahead of it is shown instead.
+	auto frameStart = std::chrono::steady_clock::now();
+	this->nes.setVideoOutput(false);
+	NESCycleOutcomes result = this->nes.executeFrame();
+	this->stats.lastFrameMS = msSince(frameStart);
+
+	auto overheadStart = std::chrono::steady_clock::now();
+	this->nes.getState(this->savedState);
+	this->nes.setAudioOutput(false);  // Only the real frames are heard; loading the state picks the audio back up from there.
+	for (unsigned int i = 1; i < this->framesAhead; ++i) {
+		this->nes.executeFrame();
+	}
+	this->nes.setVideoOutput(true);
+	this->nes.executeFrame();
+	this->nes.loadState(this->savedState);
+	this->nes.setAudioOutput(true);
+	this->stats.lastOverheadMS = msSince(overheadStart);
+
+	this->stats.maxOverheadMS = std::max(this->stats.maxOverheadMS, this->stats.lastOverheadMS);
+	this->stats.totalFrameMS += this->stats.lastFrameMS;
+	this->stats.totalOverheadMS += this->stats.lastOverheadMS;
+	this->stats.framesEmulated += 1 + this->framesAhead;
+	++this->stats.framesPresented;
+
+	return result;
+}
+
+void RunAhead::setFramesAhead(unsigned int framesAhead) {
+	this->framesAhead = framesAhead;
+}
+
+unsigned int RunAhead::getFramesAhead() const {
+	return this->framesAhead;
+}
+
+const RunAheadStats& RunAhead::getStats() const {
+	return this->stats;
+}
+
+void RunAhead::resetStats() {
+	this->stats = RunAheadStats();
+}
+
+double RunAhead::getLatencySavedMS() const {
+	return this->framesAhead * NTSC_FRAME_MS;
+}
@@ -0,0 +1,60 @@
+// runAhead.h - Hides the input lag built into games by emulating a few frames ahead and showing the last of them.
+#pragma once
+
+#include <chrono>
+
+#include "../NESEmulator.h"
+
+// Counters used to pick how many frames to run ahead for a given game. Times are in milliseconds.
+struct RunAheadStats {
+	unsigned long long framesPresented = 0;  // Frames which have been shown (one per executeFrame call).
+	unsigned long long framesEmulated = 0;  // Frames emulated in total, including the hidden ones and the ones thrown away on restore.
+
+	double lastFrameMS = 0;  // Time taken by the last real frame.
+	double lastOverheadMS = 0;  // Time taken by the last run-ahead (snapshot, frames ahead, restore).
+	double maxOverheadMS = 0;
+	double totalFrameMS = 0;
+	double totalOverheadMS = 0;
+
+	double getAverageFrameMS() const;
+	double getAverageOverheadMS() const;
+	// How much slower each presented frame is than it would be without run-ahead (e.g. 1.0 = twice as slow).
+	double getOverheadRatio() const;
+};
+
+/*
+Run-ahead works on the assumption that most games read input during a frame but only show the result of it a frame or more later.
+Each call to executeFrame:
+	1. Emulates the real next frame w/ output disabled.
+	2. Snapshots the NES.
+	3. Emulates framesAhead - 1 more frames w/ output disabled, then one more w/ output enabled, so that frame is what gets shown.
+	4. Restores the snapshot, throwing away the frames emulated ahead.
+So the picture shown is what the game would show framesAhead frames from now given the input that is held right now, which removes
+up to framesAhead frames of lag. A framesAhead of 0 just emulates and shows the next frame.
+
+NOTE: Running more frames ahead than the game's own lag makes the game look like it reacts before the input, and each frame ahead
+costs about one more frame of emulation; use the stats to choose.
+*/
+class RunAhead {
+public:
+	RunAhead(NES& nes, unsigned int framesAhead = 1);
+	~RunAhead();
+
+	// Emulates and shows a single frame, running ahead as described above.
+	NESCycleOutcomes executeFrame();
+
+	void setFramesAhead(unsigned int framesAhead);
+	unsigned int getFramesAhead() const;
+
+	const RunAheadStats& getStats() const;
+	void resetStats();
+	// How much latency is removed at the NTSC frame rate given the current number of frames ahead.
+	double getLatencySavedMS() const;
+
+private:
+	NES& nes;
+	unsigned int framesAhead;
+
+	NESState savedState;  // Where the NES is after the real frame; restored after running ahead.
+	RunAheadStats stats;
+};
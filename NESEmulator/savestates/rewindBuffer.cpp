@@ -0,0 +1,190 @@
+#include "rewindBuffer.h"
+
+#include <cstring>
+
+namespace {
+	const size_t STATE_SIZE = sizeof(NESState);
+	const size_t MIN_ZERO_RUN = 4;  // Shorter runs of 0s are cheaper to store as part of a literal than to split the literal for.
+
+	void writeVarint(std::vector<uint8_t>& out, size_t value) {
+		while (value >= 0x80) {
+			out.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	size_t readVarint(const uint8_t*& in) {
+		size_t value = 0;
+		int shift = 0;
+		uint8_t byte;
+		do {
+			byte = *in++;
+			value |= static_cast<size_t>(byte & 0x7f) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+		return value;
+	}
+
+	/* Encodes current XOR base into out as a series of (zero run length, literal length, literal bytes) tokens.
+	base may be nullptr, in which case it is treated as all 0s. */
+	void encodeDelta(const uint8_t* current, const uint8_t* base, std::vector<uint8_t>& out) {
+		auto deltaAt = [current, base](size_t i) -> uint8_t {
+			return base ? current[i] ^ base[i] : current[i];
+		};
+
+		size_t i = 0;
+		while (i < STATE_SIZE) {
+			size_t zeroRunStart = i;
+			while (i < STATE_SIZE && deltaAt(i) == 0) {
+				++i;
+			}
+			size_t zeroRun = i - zeroRunStart;
+			if (i == STATE_SIZE) {
+				break;  // The trailing run of 0s is implied.
+			}
+
+			// The literal ends at the first run of 0s long enough to be worth its own token.
+			size_t literalStart = i;
+			size_t zeros = 0;
+			while (i < STATE_SIZE && zeros < MIN_ZERO_RUN) {
+				zeros = deltaAt(i) == 0 ? zeros + 1 : 0;
+				++i;
+			}
+			if (zeros == MIN_ZERO_RUN) {
+				i -= zeros;
+			}
+
+			writeVarint(out, zeroRun);
+			writeVarint(out, i - literalStart);
+			for (size_t j = literalStart; j < i; ++j) {
+				out.push_back(deltaAt(j));
+			}
+		}
+	}
+
+	// Reverses encodeDelta; base may be nullptr, like in encodeDelta.
+	void decodeDelta(const std::vector<uint8_t>& in, const uint8_t* base, uint8_t* out) {
+		if (base) {
+			std::memcpy(out, base, STATE_SIZE);
+		} else {
+			std::memset(out, 0, STATE_SIZE);
+		}
+
+		const uint8_t* token = in.data();
+		const uint8_t* end = in.data() + in.size();
+		size_t i = 0;
+		while (token < end) {
+			i += readVarint(token);
+			size_t literalLength = readVarint(token);
+			for (size_t j = 0; j < literalLength; ++j) {
+				out[i++] ^= *token++;
+			}
+		}
+	}
+}
+
+RewindBuffer::RewindBuffer(size_t memoryCap, unsigned int keyframeInterval) :
+	keyframe(),
+	haveKeyframe(false),
+	numKeyframes(0),
+	snapshotsSinceKeyframe(0),
+	memoryUsed(0),
+	memoryCap(memoryCap),
+	keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1)
+{}
+RewindBuffer::~RewindBuffer() {}
+
+void RewindBuffer::push(const NESState& state) {
+	const uint8_t* stateBytes = reinterpret_cast<const uint8_t*>(&state);
+	bool makeKeyframe = !this->haveKeyframe || this->snapshotsSinceKeyframe + 1 >= this->keyframeInterval;
+
+	this->scratch.clear();
+	if (makeKeyframe) {
+		encodeDelta(stateBytes, nullptr, this->scratch);
+		this->keyframe = state;
+		this->haveKeyframe = true;
+		this->snapshotsSinceKeyframe = 0;
+		++this->numKeyframes;
+	} else {
+		encodeDelta(stateBytes, reinterpret_cast<const uint8_t*>(&this->keyframe), this->scratch);
+		++this->snapshotsSinceKeyframe;
+	}
+
+	// Copied out of the scratch buffer so each snapshot only holds on to as much memory as it needs.
+	this->snapshots.push_back(Snapshot{ makeKeyframe, std::vector<uint8_t>(this->scratch.begin(), this->scratch.end()) });
+	this->memoryUsed += this->scratch.size();
+
+	// The newest group is never dropped, so the cap may be briefly exceeded if it is tiny.
+	while (this->memoryUsed > this->memoryCap && this->numKeyframes > 1) {
+		this->dropOldestGroup();
+	}
+}
+
+bool RewindBuffer::pop(NESState& state) {
+	if (this->snapshots.empty()) {
+		return false;
+	}
+
+	Snapshot& newest = this->snapshots.back();
+	uint8_t* stateBytes = reinterpret_cast<uint8_t*>(&state);
+	if (newest.keyframe) {
+		decodeDelta(newest.data, nullptr, stateBytes);
+	} else {
+		decodeDelta(newest.data, reinterpret_cast<const uint8_t*>(&this->keyframe), stateBytes);
+	}
+
+	bool poppedKeyframe = newest.keyframe;
+	this->memoryUsed -= newest.data.size();
+	this->snapshots.pop_back();
+
+	if (poppedKeyframe) {
+		--this->numKeyframes;
+		this->reloadLatestKeyframe();
+	} else {
+		--this->snapshotsSinceKeyframe;
+	}
+
+	return true;
+}
+
+void RewindBuffer::clear() {
+	this->snapshots.clear();
+	this->haveKeyframe = false;
+	this->numKeyframes = 0;
+	this->snapshotsSinceKeyframe = 0;
+	this->memoryUsed = 0;
+}
+
+bool RewindBuffer::empty() const {
+	return this->snapshots.empty();
+}
+
+size_t RewindBuffer::getNumSnapshots() const {
+	return this->snapshots.size();
+}
+
+size_t RewindBuffer::getMemoryUsed() const {
+	return this->memoryUsed;
+}
+
+void RewindBuffer::dropOldestGroup() {
+	do {
+		this->memoryUsed -= this->snapshots.front().data.size();
+		this->snapshots.pop_front();
+	} while (!this->snapshots.empty() && !this->snapshots.front().keyframe);
+	--this->numKeyframes;
+}
+
+void RewindBuffer::reloadLatestKeyframe() {
+	this->haveKeyframe = false;
+	this->snapshotsSinceKeyframe = 0;
+	for (auto it = this->snapshots.rbegin(); it != this->snapshots.rend(); ++it) {
+		if (it->keyframe) {
+			decodeDelta(it->data, nullptr, reinterpret_cast<uint8_t*>(&this->keyframe));
+			this->haveKeyframe = true;
+			return;
+		}
+		++this->snapshotsSinceKeyframe;
+	}
+}
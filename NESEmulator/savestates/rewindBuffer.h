@@ -0,0 +1,63 @@
+// rewindBuffer.h - Keeps a history of recent NES states which can be stepped back through.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "../NESEmulator.h"
+
+constexpr size_t DEFAULT_REWIND_MEMORY_CAP = 64 * 1024 * 1024;  // 64 MiB; at ~1-2 KiB a snapshot this is well over 10 minutes at 60 snapshots per second.
+constexpr unsigned int DEFAULT_KEYFRAME_INTERVAL = 60;  // A keyframe every second at 60 snapshots per second.
+
+/*
+A ring of snapshots of the NES, one pushed per frame. Every keyframeInterval snapshots a keyframe is stored; every other snapshot
+is stored as the XOR of it and the latest keyframe. Since most of the state does not change between frames the XOR is mostly 0s,
+so each snapshot is then run-length encoded (runs of 0s are skipped, everything else is stored as is). Keyframes are encoded the
+same way against a state of all 0s, which still compresses the large unused parts of RAM, VRAM and OAM.
+
+When the memory used goes over the cap, the oldest keyframe is dropped along w/ every snapshot which depends on it.
+
+NOTE: Snapshots are taken from the raw bytes of NESState, so a RewindBuffer is only valid for the emulator build that made it;
+use the savestate format (saveState.h) for anything persistent.
+*/
+class RewindBuffer {
+public:
+	RewindBuffer(size_t memoryCap = DEFAULT_REWIND_MEMORY_CAP, unsigned int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+	~RewindBuffer();
+
+	// Adds the given state as the newest snapshot.
+	void push(const NESState& state);
+	// Removes the newest snapshot and writes it into state; returns false (and does not modify state) if there are no snapshots left.
+	bool pop(NESState& state);
+
+	void clear();
+
+	bool empty() const;
+	size_t getNumSnapshots() const;
+	size_t getMemoryUsed() const;  // The number of bytes the encoded snapshots take up.
+
+private:
+	struct Snapshot {
+		bool keyframe;
+		std::vector<uint8_t> data;  // The encoded XOR delta.
+	};
+
+	// Drops the oldest keyframe and every snapshot after it until the next keyframe.
+	void dropOldestGroup();
+	// Decodes the newest keyframe still in the ring into this->keyframe and recounts the snapshots made since it.
+	void reloadLatestKeyframe();
+
+	std::deque<Snapshot> snapshots;
+	std::vector<uint8_t> scratch;  // Reused encoding buffer to avoid allocating a worst-case sized buffer every push.
+
+	NESState keyframe;  // Decoded copy of the newest keyframe; deltas are taken against it.
+	bool haveKeyframe;
+	unsigned int numKeyframes;
+	unsigned int snapshotsSinceKeyframe;
+
+	size_t memoryUsed;
+	const size_t memoryCap;
+	const unsigned int keyframeInterval;
+};
@@ -0,0 +1,642 @@
+#include "saveState.h"
+
+#include <array>
+#include <cstring>
+
+#include "../NESEmulator.h"
+
+namespace {
+	const char MAGIC[4] = { 'N', 'E', 'S', 'S' };
+	const size_t STATE_HEADER_SIZE = 16;
+	const size_t STATE_TRAILER_SIZE = 4;
+
+	// Every section the NES needs to be restored; a bit per section is used to track which ones were found while decoding.
+	enum Section {
+		CPU_SECTION,
+		PPU_SECTION,
+		DMA_SECTION,
+		RAM_SECTION,
+		VRAM_SECTION,
+		CONTROLLER_SECTION,
+		NES_SECTION,
+		APU_SECTION,
+		CARTRIDGE_SECTION,
+		NUM_SECTIONS
+	};
+	const char* const SECTION_TAGS[NUM_SECTIONS] = { "CPU ", "PPU ", "DMA ", "RAM ", "VRAM", "CTRL", "NES ", "APU ", "CART" };
+	const uint32_t ALL_SECTIONS = (1 << NUM_SECTIONS) - 1;
+	const uint32_t VERSION_3_SECTIONS = ALL_SECTIONS & ~(1 << CARTRIDGE_SECTION);
+	const uint32_t VERSION_1_SECTIONS = VERSION_3_SECTIONS & ~(1 << APU_SECTION);
+
+	// Table for the reflected CRC-32 polynomial (the one zip and png use).
+	std::array<uint32_t, 256> makeCRCTable() {
+		std::array<uint32_t, 256> table{};
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; ++bit) {
+				crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+			}
+			table[i] = crc;
+		}
+		return table;
+	}
+
+	void writeCPU(StateWriter& writer, const CPUState& cpu) {
+		writer.writeU8(cpu.registers.A);
+		writer.writeU8(cpu.registers.S);
+		writer.writeU16(cpu.registers.PC);
+		writer.writeU8(cpu.registers.SP);
+		writer.writeU8(cpu.registers.X);
+		writer.writeU8(cpu.registers.Y);
+
+		writer.writeBool(cpu.interruptRequested);
+		writer.writeBool(cpu.performInterrupt);
+		writer.writeBool(cpu.nmiRequested);
+		writer.writeBool(cpu.lastNMISignal);
+		writer.writeBool(cpu.performNMI);
+		writer.writeBool(cpu.getOrPutCycle);
+
+		writer.writeU64(cpu.totalCyclesElapsed);
+		writer.writeU32(cpu.opcodeCyclesElapsed);
+		writer.writeU32(cpu.currentOpcodeCycleLen);
+	}
+
+	void readCPU(StateReader& reader, CPUState& cpu) {
+		cpu.registers.A = reader.readU8();
+		cpu.registers.S = reader.readU8();
+		cpu.registers.PC = reader.readU16();
+		cpu.registers.SP = reader.readU8();
+		cpu.registers.X = reader.readU8();
+		cpu.registers.Y = reader.readU8();
+
+		cpu.interruptRequested = reader.readBool();
+		cpu.performInterrupt = reader.readBool();
+		cpu.nmiRequested = reader.readBool();
+		cpu.lastNMISignal = reader.readBool();
+		cpu.performNMI = reader.readBool();
+		cpu.getOrPutCycle = reader.readBool();
+
+		cpu.totalCyclesElapsed = reader.readU64();
+		cpu.opcodeCyclesElapsed = reader.readU32();
+		cpu.currentOpcodeCycleLen = reader.readU32();
+	}
+
+	void writePPU(StateWriter& writer, const PPUState& ppu) {
+		writer.writeU16(ppu.latches.patternLatchLow);
+		writer.writeU16(ppu.latches.patternLatchHigh);
+		writer.writeBool(ppu.latches.attributeLatchLow);
+		writer.writeBool(ppu.latches.attributeLatchHigh);
+		writer.writeU8(ppu.latches.nametableByteLatch);
+
+		writer.writeU16(ppu.backgroundShiftRegisters.patternShiftRegisterLow);
+		writer.writeU16(ppu.backgroundShiftRegisters.patternShiftRegisterHigh);
+		writer.writeU16(ppu.backgroundShiftRegisters.attributeShiftRegisterLow);
+		writer.writeU16(ppu.backgroundShiftRegisters.attributeShiftRegisterHigh);
+
+		for (const SpriteShiftUnit& unit : ppu.spriteShiftRegisters.shiftRegisters) {
+			writer.writeU16(unit.patternShiftRegisterLow);
+			writer.writeU16(unit.patternShiftRegisterHigh);
+			writer.writeU8(static_cast<uint8_t>(unit.attributeBits));
+			writer.writeU16(static_cast<uint16_t>(unit.x));
+		}
+
+		writer.writeU16(static_cast<uint16_t>(ppu.beamPos.scanline));
+		writer.writeU16(static_cast<uint16_t>(ppu.beamPos.dot));
+		writer.writeU32(static_cast<uint32_t>(ppu.cycleCount));
+		writer.writeU32(static_cast<uint32_t>(ppu.frameCount));
+
+		writer.writeBytes(ppu.paletteControl.getData(), ppu.paletteControl.size());
+		writer.writeBytes(ppu.OAM.getData(), ppu.OAM.size());
+		writer.writeBytes(ppu.secondaryOAM.getData(), ppu.secondaryOAM.size());
+		writer.writeBool(ppu.secondaryOAM.getWriteState());
+		writer.writeU8(ppu.secondaryOAM.getFreeByteIdx());
+
+		writer.writeU8(static_cast<uint8_t>(ppu.spriteEvalCycle.byteType));
+		writer.writeU8(static_cast<uint8_t>(ppu.spriteEvalCycle.evalState));
+
+		writer.writeBool(ppu.requestingOAMDMA);
+		writer.writeU8(ppu.dmaPage);
+
+		writer.writeBool(ppu.w);
+		writer.writeU16(ppu.v);
+		writer.writeU16(ppu.t);
+		writer.writeU8(ppu.x);
+
+		writer.writeU8(ppu.control);
+		writer.writeU8(ppu.mask);
+		writer.writeU8(ppu.status);
+		writer.writeU8(ppu.OAMAddr);
+		writer.writeU8(ppu.PPUDATABuffer);
+		writer.writeU8(ppu.ioBus);
+	}
+
+	void readPPU(StateReader& reader, PPUState& ppu) {
+		ppu.latches.patternLatchLow = reader.readU16();
+		ppu.latches.patternLatchHigh = reader.readU16();
+		ppu.latches.attributeLatchLow = reader.readBool();
+		ppu.latches.attributeLatchHigh = reader.readBool();
+		ppu.latches.nametableByteLatch = reader.readU8();
+
+		ppu.backgroundShiftRegisters.patternShiftRegisterLow = reader.readU16();
+		ppu.backgroundShiftRegisters.patternShiftRegisterHigh = reader.readU16();
+		ppu.backgroundShiftRegisters.attributeShiftRegisterLow = reader.readU16();
+		ppu.backgroundShiftRegisters.attributeShiftRegisterHigh = reader.readU16();
+
+		for (SpriteShiftUnit& unit : ppu.spriteShiftRegisters.shiftRegisters) {
+			unit.patternShiftRegisterLow = reader.readU16();
+			unit.patternShiftRegisterHigh = reader.readU16();
+			unit.attributeBits = reader.readU8();
+			unit.x = static_cast<int16_t>(reader.readU16());
+		}
+
+		ppu.beamPos.scanline = static_cast<int16_t>(reader.readU16());
+		ppu.beamPos.dot = static_cast<int16_t>(reader.readU16());
+		ppu.cycleCount = static_cast<int32_t>(reader.readU32());
+		ppu.frameCount = static_cast<int32_t>(reader.readU32());
+
+		reader.readBytes(ppu.paletteControl.getData(), ppu.paletteControl.size());
+		reader.readBytes(ppu.OAM.getData(), ppu.OAM.size());
+		reader.readBytes(ppu.secondaryOAM.getData(), ppu.secondaryOAM.size());
+		ppu.secondaryOAM.setWriteState(reader.readBool());
+		ppu.secondaryOAM.setFreeByteIdx(reader.readU8());
+
+		ppu.spriteEvalCycle.byteType = static_cast<SpriteByteOn>(reader.readU8());
+		ppu.spriteEvalCycle.evalState = static_cast<SpriteEvaluationState>(reader.readU8());
+
+		ppu.requestingOAMDMA = reader.readBool();
+		ppu.dmaPage = reader.readU8();
+
+		ppu.w = reader.readBool();
+		ppu.v = reader.readU16();
+		ppu.t = reader.readU16();
+		ppu.x = reader.readU8();
+
+		ppu.control = reader.readU8();
+		ppu.mask = reader.readU8();
+		ppu.status = reader.readU8();
+		ppu.OAMAddr = reader.readU8();
+		ppu.PPUDATABuffer = reader.readU8();
+		ppu.ioBus = reader.readU8();
+	}
+
+	void writeDMA(StateWriter& writer, const OAMDMAState& dma) {
+		writer.writeU8(static_cast<uint8_t>(dma.readOrWrite));
+		writer.writeU16(dma.endAddress);
+		writer.writeU16(dma.address);
+		writer.writeU8(dma.OAMDataToTransfer);
+		writer.writeU16(dma.cyclesLeft);
+	}
+
+	void readDMA(StateReader& reader, OAMDMAState& dma, uint16_t version) {
+		dma.readOrWrite = static_cast<DMACycles::CycleType>(reader.readU8());
+		dma.endAddress = reader.readU16();
+		dma.address = reader.readU16();
+		dma.OAMDataToTransfer = reader.readU8();
+		// Older versions had no fast OAM DMA, so no DMA in them is part way through a bulk copy.
+		dma.cyclesLeft = version >= 3 ? reader.readU16() : 0;
+	}
+
+	void writeEnvelope(StateWriter& writer, const EnvelopeState& envelope) {
+		writer.writeBool(envelope.start);
+		writer.writeBool(envelope.loop);
+		writer.writeBool(envelope.constantVolume);
+		writer.writeU8(envelope.volume);
+		writer.writeU8(envelope.divider);
+		writer.writeU8(envelope.decay);
+	}
+
+	void readEnvelope(StateReader& reader, EnvelopeState& envelope) {
+		envelope.start = reader.readBool();
+		envelope.loop = reader.readBool();
+		envelope.constantVolume = reader.readBool();
+		envelope.volume = reader.readU8();
+		envelope.divider = reader.readU8();
+		envelope.decay = reader.readU8();
+	}
+
+	void writeAPU(StateWriter& writer, const APUState& apu) {
+		for (const PulseState& pulse : apu.pulse) {
+			writeEnvelope(writer, pulse.envelope);
+			writer.writeU8(pulse.duty);
+			writer.writeU8(pulse.sequenceStep);
+			writer.writeU16(pulse.timerPeriod);
+			writer.writeU32(pulse.timerCounter);
+			writer.writeU8(pulse.lengthCounter);
+			writer.writeBool(pulse.sweepEnabled);
+			writer.writeBool(pulse.sweepNegate);
+			writer.writeBool(pulse.sweepReload);
+			writer.writeU8(pulse.sweepPeriod);
+			writer.writeU8(pulse.sweepShift);
+			writer.writeU8(pulse.sweepDivider);
+		}
+
+		writer.writeBool(apu.triangle.control);
+		writer.writeBool(apu.triangle.linearReload);
+		writer.writeU8(apu.triangle.linearReloadValue);
+		writer.writeU8(apu.triangle.linearCounter);
+		writer.writeU8(apu.triangle.sequenceStep);
+		writer.writeU16(apu.triangle.timerPeriod);
+		writer.writeU32(apu.triangle.timerCounter);
+		writer.writeU8(apu.triangle.lengthCounter);
+
+		writeEnvelope(writer, apu.noise.envelope);
+		writer.writeBool(apu.noise.mode);
+		writer.writeU8(apu.noise.periodIndex);
+		writer.writeU16(apu.noise.shiftRegister);
+		writer.writeU32(apu.noise.timerCounter);
+		writer.writeU8(apu.noise.lengthCounter);
+
+		writer.writeBool(apu.dmc.irqEnabled);
+		writer.writeBool(apu.dmc.loop);
+		writer.writeU8(apu.dmc.rateIndex);
+		writer.writeU8(apu.dmc.outputLevel);
+		writer.writeU16(apu.dmc.sampleAddress);
+		writer.writeU16(apu.dmc.sampleLength);
+		writer.writeU16(apu.dmc.currentAddress);
+		writer.writeU16(apu.dmc.bytesRemaining);
+		writer.writeU8(apu.dmc.sampleBuffer);
+		writer.writeBool(apu.dmc.sampleBufferFull);
+		writer.writeU8(apu.dmc.shiftRegister);
+		writer.writeU8(apu.dmc.bitsRemaining);
+		writer.writeBool(apu.dmc.silence);
+		writer.writeU32(apu.dmc.timerCounter);
+
+		writer.writeU8(apu.channelsEnabled);
+		writer.writeBool(apu.fiveStepMode);
+		writer.writeBool(apu.irqInhibit);
+		writer.writeBool(apu.frameIRQ);
+		writer.writeBool(apu.dmcIRQ);
+		writer.writeU8(apu.frameStep);
+		writer.writeU64(apu.nextFrameStepCycle);
+		writer.writeU64(apu.frameSequenceStart);
+
+		writer.writeU64(apu.cycle);
+		writer.writeU64(apu.lastRunCycle);
+		writer.writeU64(apu.nextEventCycle);
+		writer.writeU32(apu.stallCycles);
+	}
+
+	void readAPU(StateReader& reader, APUState& apu) {
+		for (PulseState& pulse : apu.pulse) {
+			readEnvelope(reader, pulse.envelope);
+			pulse.duty = reader.readU8() & 0x03;
+			pulse.sequenceStep = reader.readU8() & 0x07;
+			pulse.timerPeriod = reader.readU16();
+			pulse.timerCounter = reader.readU32();
+			pulse.lengthCounter = reader.readU8();
+			pulse.sweepEnabled = reader.readBool();
+			pulse.sweepNegate = reader.readBool();
+			pulse.sweepReload = reader.readBool();
+			pulse.sweepPeriod = reader.readU8();
+			pulse.sweepShift = reader.readU8();
+			pulse.sweepDivider = reader.readU8();
+		}
+
+		apu.triangle.control = reader.readBool();
+		apu.triangle.linearReload = reader.readBool();
+		apu.triangle.linearReloadValue = reader.readU8();
+		apu.triangle.linearCounter = reader.readU8();
+		apu.triangle.sequenceStep = reader.readU8() & 0x1f;
+		apu.triangle.timerPeriod = reader.readU16();
+		apu.triangle.timerCounter = reader.readU32();
+		apu.triangle.lengthCounter = reader.readU8();
+
+		readEnvelope(reader, apu.noise.envelope);
+		apu.noise.mode = reader.readBool();
+		apu.noise.periodIndex = reader.readU8() & 0x0f;
+		apu.noise.shiftRegister = reader.readU16();
+		apu.noise.timerCounter = reader.readU32();
+		apu.noise.lengthCounter = reader.readU8();
+
+		apu.dmc.irqEnabled = reader.readBool();
+		apu.dmc.loop = reader.readBool();
+		apu.dmc.rateIndex = reader.readU8() & 0x0f;
+		apu.dmc.outputLevel = reader.readU8();
+		apu.dmc.sampleAddress = reader.readU16();
+		apu.dmc.sampleLength = reader.readU16();
+		apu.dmc.currentAddress = reader.readU16();
+		apu.dmc.bytesRemaining = reader.readU16();
+		apu.dmc.sampleBuffer = reader.readU8();
+		apu.dmc.sampleBufferFull = reader.readBool();
+		apu.dmc.shiftRegister = reader.readU8();
+		apu.dmc.bitsRemaining = reader.readU8();
+		apu.dmc.silence = reader.readBool();
+		apu.dmc.timerCounter = reader.readU32();
+
+		apu.channelsEnabled = reader.readU8();
+		apu.fiveStepMode = reader.readBool();
+		apu.irqInhibit = reader.readBool();
+		apu.frameIRQ = reader.readBool();
+		apu.dmcIRQ = reader.readBool();
+		apu.frameStep = reader.readU8();
+		apu.nextFrameStepCycle = reader.readU64();
+		apu.frameSequenceStart = reader.readU64();
+
+		apu.cycle = reader.readU64();
+		apu.lastRunCycle = reader.readU64();
+		apu.nextEventCycle = reader.readU64();
+		apu.stallCycles = reader.readU32();
+	}
+
+	void writeController(StateWriter& writer, const _4021& shiftRegister) {
+		writer.writeBool(shiftRegister.getCtrl());
+		writer.writeU8(shiftRegister.getRegister());
+	}
+
+	void readController(StateReader& reader, _4021& shiftRegister) {
+		bool ctrl = reader.readBool();
+		uint8_t bits = reader.readU8();
+		// The register can only be written to in parallel mode, so switch to it before restoring the old ctrl value.
+		shiftRegister.setCtrl(true);
+		shiftRegister.setRegister(bits);
+		shiftRegister.setCtrl(ctrl);
+	}
+
+	void writeMachine(StateWriter& writer, const NESState& state) {
+		writer.writeBool(state.scheduleHalt);
+		writer.writeBool(state.haltCPUOAM);
+		writer.writeU64(state.totalMachineCycles);
+	}
+
+	void readMachine(StateReader& reader, NESState& state) {
+		state.scheduleHalt = reader.readBool();
+		state.haltCPUOAM = reader.readBool();
+		state.totalMachineCycles = reader.readU64();
+	}
+}
+
+StateWriter::StateWriter(std::vector<uint8_t>& buffer) : buffer(buffer), sectionLengthPos(0) {}
+
+void StateWriter::writeU8(uint8_t value) {
+	this->buffer.push_back(value);
+}
+
+void StateWriter::writeU16(uint16_t value) {
+	this->buffer.push_back(value & 0xff);
+	this->buffer.push_back(value >> 8);
+}
+
+void StateWriter::writeU32(uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		this->buffer.push_back((value >> (8 * i)) & 0xff);
+	}
+}
+
+void StateWriter::writeU64(uint64_t value) {
+	for (int i = 0; i < 8; ++i) {
+		this->buffer.push_back((value >> (8 * i)) & 0xff);
+	}
+}
+
+void StateWriter::writeBool(bool value) {
+	this->buffer.push_back(value ? 1 : 0);
+}
+
+void StateWriter::writeBytes(const uint8_t* bytes, size_t size) {
+	this->buffer.insert(this->buffer.end(), bytes, bytes + size);
+}
+
+void StateWriter::beginSection(const char* tag) {
+	this->writeBytes(reinterpret_cast<const uint8_t*>(tag), 4);
+	this->sectionLengthPos = this->buffer.size();
+	this->writeU32(0);  // Placeholder until the section ends.
+}
+
+void StateWriter::endSection() {
+	size_t length = this->buffer.size() - this->sectionLengthPos - 4;
+	this->patchU32(this->sectionLengthPos, static_cast<uint32_t>(length));
+}
+
+size_t StateWriter::getPosition() const {
+	return this->buffer.size();
+}
+
+void StateWriter::patchU32(size_t position, uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		this->buffer[position + i] = (value >> (8 * i)) & 0xff;
+	}
+}
+
+StateReader::StateReader(const uint8_t* data, size_t size) : data(data), size(size), position(0), overrun(false) {}
+
+uint8_t StateReader::readU8() {
+	if (this->position >= this->size) {
+		this->overrun = true;
+		return 0;
+	}
+	return this->data[this->position++];
+}
+
+uint16_t StateReader::readU16() {
+	uint16_t low = this->readU8();
+	uint16_t high = this->readU8();
+	return low | (high << 8);
+}
+
+uint32_t StateReader::readU32() {
+	uint32_t value = 0;
+	for (int i = 0; i < 4; ++i) {
+		value |= static_cast<uint32_t>(this->readU8()) << (8 * i);
+	}
+	return value;
+}
+
+uint64_t StateReader::readU64() {
+	uint64_t value = 0;
+	for (int i = 0; i < 8; ++i) {
+		value |= static_cast<uint64_t>(this->readU8()) << (8 * i);
+	}
+	return value;
+}
+
+bool StateReader::readBool() {
+	return this->readU8() != 0;
+}
+
+void StateReader::readBytes(uint8_t* bytes, size_t size) {
+	if (size > this->remaining()) {
+		this->overrun = true;
+		std::memset(bytes, 0, size);
+		this->position = this->size;
+		return;
+	}
+	std::memcpy(bytes, this->data + this->position, size);
+	this->position += size;
+}
+
+void StateReader::skip(size_t size) {
+	if (size > this->remaining()) {
+		this->overrun = true;
+		this->position = this->size;
+		return;
+	}
+	this->position += size;
+}
+
+size_t StateReader::remaining() const {
+	return this->size - this->position;
+}
+
+const uint8_t* StateReader::current() const {
+	return this->data + this->position;
+}
+
+bool StateReader::overran() const {
+	return this->overrun;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+	static const std::array<uint32_t, 256> CRC_TABLE = makeCRCTable();
+
+	uint32_t crc = 0xffffffff;
+	for (size_t i = 0; i < size; ++i) {
+		crc = CRC_TABLE[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+void encodeState(const NESState& state, std::vector<uint8_t>& buffer) {
+	size_t start = buffer.size();
+	StateWriter writer{ buffer };
+
+	// Header; the payload size is patched in once every section has been written.
+	writer.writeBytes(reinterpret_cast<const uint8_t*>(MAGIC), 4);
+	writer.writeU16(SAVE_STATE_VERSION);
+	writer.writeU16(NUM_SECTIONS);
+	size_t payloadSizePos = writer.getPosition();
+	writer.writeU32(0);
+	writer.writeU32(0);
+
+	writer.beginSection(SECTION_TAGS[CPU_SECTION]);
+	writeCPU(writer, state.cpu);
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[PPU_SECTION]);
+	writePPU(writer, state.ppu);
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[DMA_SECTION]);
+	writeDMA(writer, state.dma);
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[RAM_SECTION]);
+	writer.writeBytes(state.ram.getData(), state.ram.size());
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[VRAM_SECTION]);
+	writer.writeBytes(state.vram.getData(), state.vram.size());
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[CONTROLLER_SECTION]);
+	writeController(writer, state.controllerShiftRegister);
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[NES_SECTION]);
+	writeMachine(writer, state);
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[APU_SECTION]);
+	writeAPU(writer, state.apu);
+	writer.endSection();
+
+	writer.beginSection(SECTION_TAGS[CARTRIDGE_SECTION]);
+	writer.writeBytes(state.PRGRAM.getData(), state.PRGRAM.size());
+	writer.writeBytes(state.CHRDATA.getData(), state.CHRDATA.size());
+	writer.endSection();
+
+	writer.patchU32(payloadSizePos, static_cast<uint32_t>(writer.getPosition() - start - STATE_HEADER_SIZE));
+	writer.writeU32(crc32(buffer.data() + start, buffer.size() - start));
+}
+
+SaveStateResult::SaveStateResult decodeState(const uint8_t* data, size_t size, NESState& state) {
+	if (size < STATE_HEADER_SIZE + STATE_TRAILER_SIZE) {
+		return SaveStateResult::TRUNCATED;
+	}
+
+	StateReader header{ data, STATE_HEADER_SIZE };
+	uint8_t magic[4];
+	header.readBytes(magic, 4);
+	if (std::memcmp(magic, MAGIC, 4) != 0) {
+		return SaveStateResult::BAD_MAGIC;
+	}
+	uint16_t version = header.readU16();
+	if (version > SAVE_STATE_VERSION) {
+		return SaveStateResult::UNSUPPORTED_VERSION;
+	}
+	uint16_t sectionCount = header.readU16();
+	uint32_t payloadSize = header.readU32();
+	if (payloadSize > size - STATE_HEADER_SIZE - STATE_TRAILER_SIZE) {
+		return SaveStateResult::TRUNCATED;
+	}
+
+	size_t checkedSize = STATE_HEADER_SIZE + payloadSize;
+	StateReader trailer{ data + checkedSize, STATE_TRAILER_SIZE };
+	if (trailer.readU32() != crc32(data, checkedSize)) {
+		return SaveStateResult::CHECKSUM_MISMATCH;
+	}
+
+	StateReader payload{ data + STATE_HEADER_SIZE, payloadSize };
+	uint32_t sectionsFound = 0;
+	state.apu = APUState();  // In case the section is missing from an older savestate.
+	for (uint16_t i = 0; i < sectionCount; ++i) {
+		char tag[4];
+		payload.readBytes(reinterpret_cast<uint8_t*>(tag), 4);
+		uint32_t length = payload.readU32();
+		if (payload.overran() || length > payload.remaining()) {
+			return SaveStateResult::TRUNCATED;
+		}
+
+		StateReader body{ payload.current(), length };
+		payload.skip(length);
+
+		int section = 0;
+		while (section < NUM_SECTIONS && std::memcmp(tag, SECTION_TAGS[section], 4) != 0) {
+			++section;
+		}
+
+		switch (section) {
+		case(CPU_SECTION):
+			readCPU(body, state.cpu);
+			break;
+		case(PPU_SECTION):
+			readPPU(body, state.ppu);
+			break;
+		case(DMA_SECTION):
+			readDMA(body, state.dma, version);
+			break;
+		case(RAM_SECTION):
+			body.readBytes(state.ram.getData(), state.ram.size());
+			break;
+		case(VRAM_SECTION):
+			body.readBytes(state.vram.getData(), state.vram.size());
+			break;
+		case(CONTROLLER_SECTION):
+			readController(body, state.controllerShiftRegister);
+			break;
+		case(NES_SECTION):
+			readMachine(body, state);
+			break;
+		case(APU_SECTION):
+			readAPU(body, state.apu);
+			break;
+		case(CARTRIDGE_SECTION):
+			body.readBytes(state.PRGRAM.getData(), state.PRGRAM.size());
+			body.readBytes(state.CHRDATA.getData(), state.CHRDATA.size());
+			break;
+		default:  // Unknown section; probably from a newer version, so it is skipped.
+			continue;
+		}
+
+		if (body.overran()) {
+			return SaveStateResult::TRUNCATED;
+		}
+		sectionsFound |= 1 << section;
+	}
+
+	uint32_t requiredSections = version >= 4 ? ALL_SECTIONS : version >= 2 ? VERSION_3_SECTIONS : VERSION_1_SECTIONS;
+	if ((sectionsFound & requiredSections) != requiredSections) {
+		return SaveStateResult::MISSING_SECTION;
+	}
+
+	return SaveStateResult::SUCCESS;
+}
@@ -0,0 +1,104 @@
+// saveState.h - The binary savestate format; converts an NESState to and from a compact, versioned byte buffer.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+struct NESState;
+
+/*
+FORMAT (all multi-byte values are little-endian regardless of the host):
+
+	Header (16 bytes)
+		char[4]  magic           "NESS"
+		uint16   version         SAVE_STATE_VERSION
+		uint16   sectionCount
+		uint32   payloadSize     Size in bytes of all the sections combined.
+		uint32   reserved        Always 0.
+	Sections (sectionCount of them, back to back)
+		char[4]  tag             e.g. "CPU ", "PPU ", "RAM "
+		uint32   length          Size of the body in bytes.
+		uint8[]  body
+	Trailer
+		uint32   checksum        CRC-32 of the header and every section.
+
+Each component gets its own section and every field is written one at a time at a fixed width, so the format does not depend
+on struct layout, padding or the size of int on the compiler that made the file.
+
+NOTE: Sections with an unknown tag are skipped and bytes past the end of a known section's fields are ignored, so fields may be
+appended to a section without breaking older readers; removing or reordering fields requires bumping SAVE_STATE_VERSION.
+*/
+
+// Version 2 added the APU section; version 1 savestates still load, w/ the APU as it is at power on. Version 3 added the cycles 
+// left in a bulk OAM DMA copy to the DMA section. Version 4 added the cartridge section (PRG RAM and CHRDATA); older savestates 
+// leave those as they are in the NESState decoded into.
+const uint16_t SAVE_STATE_VERSION = 4;
+
+namespace SaveStateResult {
+	enum SaveStateResult {
+		SUCCESS,
+		CANT_OPEN_FILE,
+		BAD_MAGIC,  // Not a savestate.
+		UNSUPPORTED_VERSION,  // Made by a newer version of the emulator.
+		CHECKSUM_MISMATCH,  // The savestate is corrupted.
+		TRUNCATED,  // The buffer or a section ends before it should.
+		MISSING_SECTION  // A section required to restore the NES is absent.
+	};
+};
+
+// Appends fixed-width little-endian values to a byte buffer.
+class StateWriter {
+public:
+	StateWriter(std::vector<uint8_t>& buffer);
+
+	void writeU8(uint8_t value);
+	void writeU16(uint16_t value);
+	void writeU32(uint32_t value);
+	void writeU64(uint64_t value);
+	void writeBool(bool value);
+	void writeBytes(const uint8_t* bytes, size_t size);
+
+	// Starts a section w/ the given 4 character tag; its length is filled in by endSection.
+	void beginSection(const char* tag);
+	void endSection();
+
+	size_t getPosition() const;
+	// Overwrites a previously written uint32 at the given position.
+	void patchU32(size_t position, uint32_t value);
+
+private:
+	std::vector<uint8_t>& buffer;
+	size_t sectionLengthPos;  // Where the length of the current section is.
+};
+
+// Reads fixed-width little-endian values from a byte buffer. Reading past the end yields 0s and sets the overrun flag instead of throwing.
+class StateReader {
+public:
+	StateReader(const uint8_t* data, size_t size);
+
+	uint8_t readU8();
+	uint16_t readU16();
+	uint32_t readU32();
+	uint64_t readU64();
+	bool readBool();
+	void readBytes(uint8_t* bytes, size_t size);
+	void skip(size_t size);
+
+	size_t remaining() const;
+	const uint8_t* current() const;
+	bool overran() const;  // Whether a read went past the end of the data.
+
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t position;
+	bool overrun;
+};
+
+uint32_t crc32(const uint8_t* data, size_t size);
+
+// Appends the encoded state to buffer (the buffer is not cleared first).
+void encodeState(const NESState& state, std::vector<uint8_t>& buffer);
+// Decodes a buffer made by encodeState. The state is only partially written to if this fails, so decode into a temporary if that matters.
+SaveStateResult::SaveStateResult decodeState(const uint8_t* data, size_t size, NESState& state);
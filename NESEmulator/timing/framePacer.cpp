@@ -0,0 +1,69 @@
+#include "framePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+FramePacer::FramePacer(double frameRate) :
+	framePeriod(1.0 / frameRate),
+	epoch(Clock::now()),
+	nextFrame(1),
+	spinMargin(DEFAULT_SPIN_MARGIN)
+{}
+FramePacer::~FramePacer() {}
+
+void FramePacer::restart(Clock::time_point now) {
+	this->epoch = now;
+	this->nextFrame = 1;
+}
+
+void FramePacer::skipFrames(unsigned long long numFrames) {
+	this->nextFrame += numFrames;
+}
+
+void FramePacer::waitForNextFrame() {
+	Clock::time_point deadline = this->getDeadline(this->nextFrame);
+	++this->nextFrame;
+
+	Clock::time_point wakeTarget = deadline - this->spinMargin;
+	if (Clock::now() < wakeTarget) {
+		std::this_thread::sleep_until(wakeTarget);
+
+		// If the OS overslept past the margin, widen the margin (up to half a frame) so the next deadline is not missed. 
+		// Otherwise let it shrink back slowly, since every bit of margin is time spent spinning.
+		Clock::duration oversleep = Clock::now() - wakeTarget;
+		Clock::duration maxMargin = this->getFramePeriod() / 2;
+		if (oversleep > this->spinMargin) {
+			this->spinMargin = std::min(oversleep + oversleep / 4, maxMargin);
+		} else if (this->spinMargin > DEFAULT_SPIN_MARGIN) {
+			this->spinMargin = std::max<Clock::duration>(this->spinMargin - this->spinMargin / 64, DEFAULT_SPIN_MARGIN);
+		}
+	}
+
+	while (Clock::now() < deadline) {
+		// Spin; yielding here would hand the wait back to the OS scheduler.
+	}
+}
+
+FramePacer::Clock::time_point FramePacer::getNextDeadline() const {
+	return this->getDeadline(this->nextFrame);
+}
+
+unsigned long long FramePacer::getFramesBehind(Clock::time_point now) const {
+	Clock::time_point deadline = this->getDeadline(this->nextFrame);
+	if (now <= deadline) {
+		return 0;
+	}
+	return static_cast<unsigned long long>(std::chrono::duration<double>(now - deadline) / this->framePeriod) + 1;
+}
+
+FramePacer::Clock::duration FramePacer::getFramePeriod() const {
+	return std::chrono::duration_cast<Clock::duration>(this->framePeriod);
+}
+
+FramePacer::Clock::duration FramePacer::getSpinMargin() const {
+	return this->spinMargin;
+}
+
+FramePacer::Clock::time_point FramePacer::getDeadline(unsigned long long frame) const {
+	return this->epoch + std::chrono::duration_cast<Clock::duration>(this->framePeriod * static_cast<double>(frame));
+}
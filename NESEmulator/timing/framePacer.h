@@ -0,0 +1,50 @@
+// framePacer.h - Waits for frames to be due at a precise, non-drifting rate.
+#pragma once
+
+#include <chrono>
+
+constexpr double NTSC_FRAME_RATE = 60.0988;  // Frames per second of an NTSC NES (the PPU's 5369318 Hz / 89341.5 dots per frame).
+
+/*
+Keeps a schedule of frame deadlines and waits for them. 
+
+Deadlines are absolute: the n-th deadline after a restart is computed as restart time + n frame periods rather than by adding 
+one period to the last deadline, so neither the time spent emulating nor rounding the period to the clock's resolution makes the 
+frame rate drift. The frame rate is exact on average even though each frame lasts a whole number of clock ticks.
+
+OS sleeps are only accurate to a millisecond or so (much worse on some systems), so waiting is done by sleeping until shortly 
+before the deadline and then spinning for the rest. The spin margin starts at DEFAULT_SPIN_MARGIN and grows if the OS is seen 
+oversleeping by more than it, so a coarse scheduler costs some CPU time instead of missed deadlines.
+*/
+class FramePacer {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::chrono::microseconds DEFAULT_SPIN_MARGIN{ 1000 };
+
+	FramePacer(double frameRate = NTSC_FRAME_RATE);
+	~FramePacer();
+
+	// Starts the schedule over; the next deadline is one period after now.
+	void restart(Clock::time_point now = Clock::now());
+	// Moves the next deadline numFrames periods later, e.g. when frames are skipped to catch up.
+	void skipFrames(unsigned long long numFrames);
+	// Waits until the next deadline (returning immediately if it has passed), then moves on to the one after it.
+	void waitForNextFrame();
+
+	Clock::time_point getNextDeadline() const;
+	// How many deadlines have passed w/o being waited for as of now (0 if the next one has not passed).
+	unsigned long long getFramesBehind(Clock::time_point now = Clock::now()) const;
+
+	Clock::duration getFramePeriod() const;  // Rounded to the clock's resolution.
+	Clock::duration getSpinMargin() const;
+
+private:
+	Clock::time_point getDeadline(unsigned long long frame) const;
+
+	const std::chrono::duration<double> framePeriod;
+	Clock::time_point epoch;  // When the schedule was last restarted.
+	unsigned long long nextFrame;  // The number of periods after the epoch the next deadline is.
+
+	Clock::duration spinMargin;
+};
@@ -0,0 +1,110 @@
+#include "speedControl.h"
+
+#include <algorithm>
+
+namespace {
+	const std::chrono::milliseconds SPEED_WINDOW{ 500 };
+	const unsigned int FRAME_TIME_LOOKBACK = 600;  // About 10 seconds; enough frames for the 99th percentile to mean something.
+}
+
+SpeedControl::SpeedControl(unsigned int turboInterval, unsigned int maxFrameSkip) :
+	mode(SpeedMode::NORMAL),
+	turboInterval(turboInterval > 0 ? turboInterval : 1),
+	maxFrameSkip(maxFrameSkip),
+	pacer(NTSC_FRAME_RATE),
+	restartDeadlines(true),
+	framesThisCall(0),
+	windowStart(Clock::now()),
+	windowFrames(0),
+	frameCounter(FRAME_TIME_LOOKBACK)
+{}
+SpeedControl::~SpeedControl() {}
+
+unsigned int SpeedControl::beginFrame() {
+	Clock::time_point now = Clock::now();
+	unsigned int framesToSkip = 0;
+
+	if (this->mode == SpeedMode::TURBO) {
+		framesToSkip = this->turboInterval - 1;
+	} else if (this->restartDeadlines) {
+		this->pacer.restart(now);
+		this->restartDeadlines = false;
+	} else if (unsigned long long framesBehind = this->pacer.getFramesBehind(now)) {
+		// Every deadline which has already passed is a frame the host missed.
+		framesToSkip = static_cast<unsigned int>(std::min<unsigned long long>(framesBehind, this->maxFrameSkip));
+		this->pacer.skipFrames(framesToSkip);
+		this->stats.framesSkipped += framesToSkip;
+
+		if (framesBehind > this->maxFrameSkip) {
+			this->stats.framesDropped += framesBehind - this->maxFrameSkip;
+			this->pacer.restart(now);
+		}
+	}
+
+	this->framesThisCall = framesToSkip + 1;
+	return framesToSkip;
+}
+
+void SpeedControl::endFrame() {
+	this->stats.framesEmulated += this->framesThisCall;
+	++this->stats.framesPresented;
+	this->windowFrames += this->framesThisCall;
+
+	if (this->mode == SpeedMode::NORMAL && !this->restartDeadlines) {
+		this->pacer.waitForNextFrame();
+	}
+	this->frameCounter.countFrame();
+
+	this->updateSpeedMultiplier(Clock::now());
+}
+
+void SpeedControl::setMode(SpeedMode::SpeedMode mode) {
+	if (mode != this->mode) {
+		this->restartDeadlines = true;
+	}
+	this->mode = mode;
+}
+
+SpeedMode::SpeedMode SpeedControl::getMode() const {
+	return this->mode;
+}
+
+void SpeedControl::setTurboInterval(unsigned int turboInterval) {
+	this->turboInterval = std::clamp(turboInterval, 1u, MAX_TURBO_INTERVAL);
+}
+
+unsigned int SpeedControl::getTurboInterval() const {
+	return this->turboInterval;
+}
+
+void SpeedControl::setMaxFrameSkip(unsigned int maxFrameSkip) {
+	this->maxFrameSkip = maxFrameSkip;
+}
+
+unsigned int SpeedControl::getMaxFrameSkip() const {
+	return this->maxFrameSkip;
+}
+
+const SpeedStats& SpeedControl::getStats() const {
+	return this->stats;
+}
+
+void SpeedControl::resetStats() {
+	this->stats = SpeedStats();
+	this->windowStart = Clock::now();
+	this->windowFrames = 0;
+}
+
+void SpeedControl::updateSpeedMultiplier(Clock::time_point now) {
+	std::chrono::duration<double> elapsed = now - this->windowStart;
+	if (elapsed < SPEED_WINDOW) {
+		return;
+	}
+
+	this->stats.speedMultiplier = this->windowFrames / elapsed.count() / NTSC_FRAME_RATE;
+	// Sorting the frame times every frame would be wasted work, so they are only updated along w/ the speed.
+	this->stats.frameTimeP50 = this->frameCounter.getFrameTimePercentile(50);
+	this->stats.frameTimeP99 = this->frameCounter.getFrameTimePercentile(99);
+	this->windowStart = now;
+	this->windowFrames = 0;
+}
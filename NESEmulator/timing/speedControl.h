@@ -0,0 +1,87 @@
+// speedControl.h - Decides how many frames to emulate per frame shown and keeps the emulation running at the right speed.
+#pragma once
+
+#include <chrono>
+
+#include "framePacer.h"
+#include "../debuggingTools/frameCounter.h"
+
+namespace SpeedMode {
+	enum SpeedMode {
+		NORMAL,  // Real-time; frames are skipped only to catch up when the host falls behind.
+		TURBO,  // As fast as the host allows; only 1 in every getTurboInterval() frames is shown.
+	};
+};
+
+// Counters to show the user how fast the emulation is going.
+struct SpeedStats {
+	unsigned long long framesEmulated = 0;  // Shown and skipped frames.
+	unsigned long long framesPresented = 0;
+	unsigned long long framesSkipped = 0;  // Frames skipped in normal mode because the host fell behind (turbo's hidden frames are not counted).
+	unsigned long long framesDropped = 0;  // Frames given up on in normal mode because the host fell too far behind to catch up.
+
+	double speedMultiplier = 0;  // How fast the game is running compared to a real NES (e.g. 1.0 = full speed, 8.0 = 8 times faster).
+	// The median and 99th percentile time between frames shown (in ms) as paced by endFrame, over the last FRAME_TIME_LOOKBACK frames.
+	double frameTimeP50 = 0, frameTimeP99 = 0;
+};
+
+/*
+Used by the frontend's main loop:
+	1. beginFrame() returns how many frames to emulate w/o showing them (see NES::setVideoOutput).
+	2. The frontend emulates those frames, then emulates and shows one more.
+	3. endFrame() records the frames and, in normal mode, waits until the next frame is due.
+
+In normal mode each frame has a deadline 1 / NTSC_FRAME_RATE seconds after the last one (see FramePacer). If the host finishes a frame after the
+next deadline has passed, the frames it missed are skipped (emulated but not shown) to get back to real-time, at most maxFrameSkip 
+of them per frame shown so the picture keeps updating. If the host falls behind by more than that, the remaining frames are dropped 
+and the deadlines start over from the current time, so the emulation slows down for a moment instead of fast-forwarding to catch up.
+
+Switching between modes starts the deadlines over too; leaving turbo mode goes straight back to real-time.
+*/
+// The most frames turbo mode emulates per frame shown; beyond this the window would barely ever update.
+constexpr unsigned int MAX_TURBO_INTERVAL = 64;
+
+class SpeedControl {
+public:
+	SpeedControl(unsigned int turboInterval = 8, unsigned int maxFrameSkip = 4);
+	~SpeedControl();
+
+	// Returns the number of frames to emulate and skip before the one which is shown.
+	unsigned int beginFrame();
+	// Counts the frames from beginFrame as emulated and waits for the next frame if in normal mode.
+	void endFrame();
+
+	void setMode(SpeedMode::SpeedMode mode);
+	SpeedMode::SpeedMode getMode() const;
+
+	// One in every turboInterval frames is shown in turbo mode; clamped to 1 - MAX_TURBO_INTERVAL.
+	void setTurboInterval(unsigned int turboInterval);
+	unsigned int getTurboInterval() const;
+
+	void setMaxFrameSkip(unsigned int maxFrameSkip);
+	unsigned int getMaxFrameSkip() const;
+
+	const SpeedStats& getStats() const;
+	void resetStats();
+
+private:
+	using Clock = FramePacer::Clock;
+
+	void updateSpeedMultiplier(Clock::time_point now);
+
+	SpeedMode::SpeedMode mode;
+	unsigned int turboInterval;
+	unsigned int maxFrameSkip;
+
+	FramePacer pacer;  // Holds the deadlines for normal mode.
+	bool restartDeadlines;  // Set when the deadlines should start over from the current time on the next beginFrame.
+	unsigned int framesThisCall;  // The number of frames beginFrame told the frontend to emulate (including the shown one).
+
+	// The speed is measured over windows of at least SPEED_WINDOW so it does not jitter from frame to frame.
+	Clock::time_point windowStart;
+	unsigned long long windowFrames;
+
+	FrameCounter frameCounter;  // Counts each frame once endFrame is done waiting for it, for the frame time percentiles.
+
+	SpeedStats stats;
+};